@@ -0,0 +1,242 @@
+#include "decoder.h"
+
+#include <array>
+#include <charconv>
+#include <cstring>
+#include <fcntl.h>
+#include <stdexcept>
+#include <string>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace decoder
+{
+
+MappedFile::MappedFile(const char* path)
+{
+    int fd{open(path, O_RDONLY)};
+    if (fd < 0)
+        throw std::runtime_error(std::string("could not open ") + path + ": " + strerror(errno));
+    struct stat st;
+    if (fstat(fd, &st) != 0)
+    {
+        close(fd);
+        throw std::runtime_error(std::string("could not stat ") + path + ": " + strerror(errno));
+    }
+    length = st.st_size;
+    if (length > 0)
+    {
+        void* mapping{mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0)};
+        if (mapping == MAP_FAILED)
+        {
+            close(fd);
+            throw std::runtime_error(std::string("could not map ") + path + ": " + strerror(errno));
+        }
+        contents = static_cast<uint8_t*>(mapping);
+        madvise(contents, length, MADV_SEQUENTIAL);
+    }
+    close(fd);
+}
+
+MappedFile::~MappedFile()
+{
+    if (contents != nullptr)
+        munmap(contents, length);
+}
+
+uint32_t crc32(uint32_t crc, const uint8_t* data, size_t size)
+{
+    static const std::array<uint32_t, 256> table{[]
+                                                 {
+                                                     std::array<uint32_t, 256> table{};
+                                                     for (uint32_t i{0}; i < table.size(); i++)
+                                                     {
+                                                         uint32_t c{i};
+                                                         for (int bit{0}; bit < 8; bit++)
+                                                             c = (c & 1) ? 0xEDB88320 ^ (c >> 1) : c >> 1;
+                                                         table[i] = c;
+                                                     }
+                                                     return table;
+                                                 }()};
+    crc = ~crc;
+    for (size_t i{0}; i < size; i++)
+        crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+    return ~crc;
+}
+
+std::vector<uint8_t> reassembleExport(const uint8_t* data, size_t size)
+{
+    // frame layout: ('M', 'X')(type, 1 byte)(offset, 4 bytes)(length, 2 bytes)(data)(CRC32 of type, offset, length and data, 4 bytes)
+    constexpr size_t headerLength{2 + 1 + 4 + 2};
+    constexpr size_t crcLength{4};
+    std::vector<uint8_t> contents;
+    std::optional<uint32_t> fileSize;
+    size_t i{0};
+    while (i + headerLength + crcLength <= size)
+    {
+        if (data[i] != 'M' || data[i + 1] != 'X')
+        {
+            i++;
+            continue;
+        }
+        uint32_t offset;
+        uint16_t length;
+        memcpy(&offset, &data[i + 3], sizeof(offset));
+        memcpy(&length, &data[i + 7], sizeof(length));
+        uint32_t crc;
+        if (i + headerLength + length + crcLength > size)
+        {
+            i++;
+            continue;
+        }
+        memcpy(&crc, &data[i + headerLength + length], sizeof(crc));
+        if (crc32(0, &data[i + 2], headerLength - 2 + length) != crc)
+        {
+            i++;
+            continue;
+        }
+        char type = data[i + 2];
+        if (type == 'H')
+        {
+            uint32_t headerFileSize;
+            memcpy(&headerFileSize, &data[i + headerLength], sizeof(headerFileSize));
+            fileSize = headerFileSize;
+        }
+        else if (type == 'B' && offset == contents.size())
+        {
+            contents.insert(contents.end(), &data[i + headerLength], &data[i + headerLength + length]);
+        }
+        // frames at other offsets stem from aborted exports and are covered by the resumed export
+        i += headerLength + length + crcLength;
+    }
+    if (fileSize && contents.size() < *fileSize)
+        fprintf(stderr, "Export capture incomplete: %zu of %u bytes.\n", contents.size(), *fileSize);
+    return contents;
+}
+
+std::vector<uint8_t> parseHexDump(const uint8_t* data, size_t size)
+{
+    static constexpr char marker[]{" bytes"};
+    const uint8_t* start{data};
+    const uint8_t* found{static_cast<const uint8_t*>(memmem(data, size, marker, sizeof(marker) - 1))};
+    if (found != nullptr)
+        start = found + sizeof(marker) - 1;
+    while (start < data + size && (*start == '\r' || *start == '\n'))
+        start++;
+    auto nibble = [](uint8_t c) -> int
+    {
+        if (c >= '0' && c <= '9')
+            return c - '0';
+        if (c >= 'A' && c <= 'F')
+            return c - 'A' + 10;
+        if (c >= 'a' && c <= 'f')
+            return c - 'a' + 10;
+        return -1;
+    };
+    std::vector<uint8_t> contents;
+    contents.reserve((data + size - start) / 2);
+    for (const uint8_t* c{start}; c + 1 < data + size; c += 2)
+    {
+        int high{nibble(c[0])}, low{nibble(c[1])};
+        if (high < 0 || low < 0)
+            break;
+        contents.push_back(high << 4 | low);
+    }
+    return contents;
+}
+
+std::optional<Record> RecordReader::next()
+{
+    constexpr size_t minimumSize{MessageHeader::headerLength + sizeof(uint16_t) + sizeof(uint32_t) + sizeof(uint8_t)};
+    while (position < end)
+    {
+        uint8_t size{position[0]};
+        uint8_t* record{position + 1};
+        if (record + size > end)
+            return std::nullopt;
+        position = record + size;
+        if (size < minimumSize || size != minimumSize + record[minimumSize - 1] * sizeof(SensorValue))
+        {
+            invalid++;
+            continue;
+        }
+        bool uploaded{record[0] != 0};
+        return Record{uploaded, &Message<SENSOR_DATA>::fromData(record)};
+    }
+    return std::nullopt;
+}
+
+bool Filter::accepts(const Record& record) const
+{
+    uint32_t time{record.message->getCTime()};
+    return time >= from && time <= to && (!node || *node == record.message->getSource());
+}
+
+void CsvWriter::reserve(size_t size)
+{
+    if (length + size > buffer.size())
+        flush();
+}
+
+void CsvWriter::flush()
+{
+    fwrite(buffer.data(), 1, length, output);
+    length = 0;
+}
+
+void CsvWriter::writeHeader()
+{
+    static constexpr char header[]{"source,destination,sequence,time,uploaded,type,instance,value\n"};
+    reserve(sizeof(header));
+    memcpy(&buffer[length], header, sizeof(header) - 1);
+    length += sizeof(header) - 1;
+}
+
+/// @brief Formats a MAC address like MACAddress::toString, without going through snprintf.
+static char* formatMAC(char* out, const MACAddress& mac)
+{
+    static constexpr char digits[]{"0123456789ABCDEF"};
+    const uint8_t* address{mac.getAddress()};
+    for (size_t i{0}; i < MACAddress::length; i++)
+    {
+        *out++ = digits[address[i] >> 4];
+        *out++ = digits[address[i] & 0xF];
+        *out++ = i + 1 < MACAddress::length ? ':' : ',';
+    }
+    return out;
+}
+
+void CsvWriter::write(const Record& record)
+{
+    Message<SENSOR_DATA>& m{*record.message};
+    // common prefix of all lines of this record
+    char prefix[2 * MACAddress::stringLength + 32];
+    char* p{formatMAC(prefix, m.getSource())};
+    p = formatMAC(p, m.getDest());
+    p = std::to_chars(p, std::end(prefix), m.getSequence()).ptr;
+    *p++ = ',';
+    p = std::to_chars(p, std::end(prefix), m.getCTime()).ptr;
+    *p++ = ',';
+    *p++ = record.uploaded ? '1' : '0';
+    *p++ = ',';
+    size_t prefixLength = p - prefix;
+    const SensorValue* values{m.getValues()};
+    for (size_t i{0}; i < m.getNValues(); i++)
+    {
+        reserve(prefixLength + 64);
+        char* out{&buffer[length]};
+        memcpy(out, prefix, prefixLength);
+        out += prefixLength;
+        SensorValue value{values[i]};
+        out = std::to_chars(out, out + 8, value.tag >> 4).ptr;
+        *out++ = ',';
+        out = std::to_chars(out, out + 4, value.tag & 0xF).ptr;
+        *out++ = ',';
+        out = std::to_chars(out, out + 32, value.value).ptr;
+        *out++ = '\n';
+        length = out - buffer.data();
+    }
+}
+
+} // namespace decoder
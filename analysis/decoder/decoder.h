@@ -0,0 +1,118 @@
+#ifndef __DECODER_H__
+#define __DECODER_H__
+
+#include <CommunicationCommon.h>
+
+#include <optional>
+#include <stdio.h>
+#include <vector>
+
+/// @brief Host-side decoder of the binary formats written by the firmware. The record layout is not duplicated here: records are interpreted with the
+/// firmware's own Message<SENSOR_DATA> definition from CommunicationCommon.h.
+namespace decoder
+{
+
+/// @brief Private, writable memory mapping of a file. Writes are never carried through to the file, which allows in-place interpretation of its
+/// contents (Message::fromData clamps the value count in place).
+class MappedFile
+{
+    uint8_t* contents{nullptr};
+    size_t length{0};
+
+public:
+    /// @brief Maps the file into memory.
+    /// @param path Path of the file.
+    /// @throws std::runtime_error if the file cannot be opened or mapped.
+    explicit MappedFile(const char* path);
+    ~MappedFile();
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    uint8_t* data() { return contents; }
+    size_t size() const { return length; }
+};
+
+/// @brief Formats that can be decoded.
+enum class InputFormat
+{
+    /// @brief Image of a sensor data file (e.g. data.dat), as written by MIRRAModule::storeSensorData.
+    RAW,
+    /// @brief Raw serial capture of the 'export' command, see CommonCommands::exportFile.
+    EXPORT,
+    /// @brief Serial capture or log holding the output of the 'printhex' command.
+    HEX
+};
+
+/// @brief Reassembles the file contents from a serial capture of the 'export' command. Frames that fail their CRC are skipped.
+/// @param data The capture.
+/// @param size Size of the capture in bytes.
+/// @return The file contents, up to the first missing frame.
+std::vector<uint8_t> reassembleExport(const uint8_t* data, size_t size);
+/// @brief Extracts the file contents from a capture of the 'printhex' command, i.e. pairs of hex digits following the "... with size N bytes" line.
+/// @param data The capture.
+/// @param size Size of the capture in bytes.
+/// @return The file contents.
+std::vector<uint8_t> parseHexDump(const uint8_t* data, size_t size);
+/// @brief Computes the CRC32 (as in zlib and the ESP32 ROM crc32_le) of a buffer.
+/// @param crc CRC of the preceding data, 0 at the start.
+uint32_t crc32(uint32_t crc, const uint8_t* data, size_t size);
+
+/// @brief A sensor data record as stored in a sensor data file.
+struct Record
+{
+    /// @brief Whether the record has been uploaded (by the node to the gateway, or by the gateway to the server).
+    bool uploaded;
+    Message<SENSOR_DATA>* message;
+};
+
+/// @brief Iterates over the records of a sensor data file image, with the following layout: "(record size, 1 byte)(upload flag, 1 byte)(sensor data message
+/// without its type byte)...".
+class RecordReader
+{
+    uint8_t* position;
+    uint8_t* end;
+    size_t invalid{0};
+
+public:
+    /// @param data Sensor data file image. Record value counts are clamped in place.
+    /// @param size Size of the image in bytes.
+    RecordReader(uint8_t* data, size_t size) : position{data}, end{data + size} {}
+    /// @return The next record, disengaged at the end of the image or at a truncated record.
+    std::optional<Record> next();
+    /// @return The amount of records skipped because their size does not match their value count.
+    size_t getInvalid() const { return invalid; }
+};
+
+/// @brief Selects records by source node and time range.
+struct Filter
+{
+    std::optional<MACAddress> node;
+    uint32_t from{0};
+    uint32_t to{UINT32_MAX};
+
+    bool accepts(const Record& record) const;
+};
+
+/// @brief Writes the values of records as CSV lines ("source,destination,sequence,time,uploaded,type,instance,value"), buffered to keep up with mapped
+/// input.
+class CsvWriter
+{
+    FILE* output;
+    std::vector<char> buffer;
+    size_t length{0};
+
+    void reserve(size_t size);
+
+public:
+    explicit CsvWriter(FILE* output, size_t bufferSize = 1 << 20) : output{output}, buffer(bufferSize) {}
+    ~CsvWriter() { flush(); }
+
+    void writeHeader();
+    /// @brief Writes a line per value of the record.
+    void write(const Record& record);
+    void flush();
+};
+
+} // namespace decoder
+
+#endif
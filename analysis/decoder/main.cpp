@@ -0,0 +1,140 @@
+#include "decoder.h"
+
+#include <chrono>
+#include <cstring>
+#include <getopt.h>
+#include <stdexcept>
+
+static void usage(const char* program)
+{
+    fprintf(stderr,
+            "Usage: %s [options] FILE...\n"
+            "Decodes MIRRA sensor data files to CSV (source,destination,sequence,time,uploaded,type,instance,value).\n\n"
+            "  -f, --format FORMAT  raw (data.dat image, default), export (capture of the 'export' command) or hex (capture of 'printhex')\n"
+            "  -n, --node MAC       only records from this node (00:00:00:00:00:00)\n"
+            "  -s, --from TIME      only records sampled at or after TIME (UNIX epoch, seconds)\n"
+            "  -e, --to TIME        only records sampled at or before TIME (UNIX epoch, seconds)\n"
+            "  -u, --pending        only records not uploaded yet\n"
+            "  -o, --output FILE    write CSV to FILE instead of stdout\n"
+            "  -q, --quiet          do not print statistics to stderr\n",
+            program);
+}
+
+int main(int argc, char** argv)
+{
+    static const option options[]{{"format", required_argument, nullptr, 'f'}, {"node", required_argument, nullptr, 'n'},
+                                  {"from", required_argument, nullptr, 's'},   {"to", required_argument, nullptr, 'e'},
+                                  {"pending", no_argument, nullptr, 'u'},      {"output", required_argument, nullptr, 'o'},
+                                  {"quiet", no_argument, nullptr, 'q'},        {"help", no_argument, nullptr, 'h'},
+                                  {nullptr, 0, nullptr, 0}};
+    decoder::InputFormat format{decoder::InputFormat::RAW};
+    decoder::Filter filter;
+    bool pendingOnly{false};
+    bool quiet{false};
+    const char* outputPath{nullptr};
+    int option;
+    while ((option = getopt_long(argc, argv, "f:n:s:e:uo:qh", options, nullptr)) != -1)
+    {
+        switch (option)
+        {
+        case 'f':
+            if (strcmp(optarg, "raw") == 0)
+                format = decoder::InputFormat::RAW;
+            else if (strcmp(optarg, "export") == 0)
+                format = decoder::InputFormat::EXPORT;
+            else if (strcmp(optarg, "hex") == 0)
+                format = decoder::InputFormat::HEX;
+            else
+            {
+                fprintf(stderr, "Unknown format '%s'.\n", optarg);
+                return 2;
+            }
+            break;
+        case 'n':
+            if (strlen(optarg) != MACAddress::stringLength - 1)
+            {
+                fprintf(stderr, "Invalid MAC address '%s'.\n", optarg);
+                return 2;
+            }
+            filter.node = MACAddress::fromString(optarg);
+            break;
+        case 's':
+            filter.from = strtoul(optarg, nullptr, 10);
+            break;
+        case 'e':
+            filter.to = strtoul(optarg, nullptr, 10);
+            break;
+        case 'u':
+            pendingOnly = true;
+            break;
+        case 'o':
+            outputPath = optarg;
+            break;
+        case 'q':
+            quiet = true;
+            break;
+        default:
+            usage(argv[0]);
+            return option == 'h' ? 0 : 2;
+        }
+    }
+    if (optind >= argc)
+    {
+        usage(argv[0]);
+        return 2;
+    }
+    FILE* output{outputPath ? fopen(outputPath, "w") : stdout};
+    if (output == nullptr)
+    {
+        fprintf(stderr, "Could not open '%s' for writing: %s\n", outputPath, strerror(errno));
+        return 1;
+    }
+    auto start{std::chrono::steady_clock::now()};
+    size_t records{0}, selected{0}, invalid{0};
+    {
+        decoder::CsvWriter writer{output};
+        writer.writeHeader();
+        for (int i{optind}; i < argc; i++)
+        {
+            try
+            {
+                decoder::MappedFile file{argv[i]};
+                std::vector<uint8_t> converted;
+                uint8_t* data{file.data()};
+                size_t size{file.size()};
+                if (format == decoder::InputFormat::EXPORT)
+                    converted = decoder::reassembleExport(data, size);
+                else if (format == decoder::InputFormat::HEX)
+                    converted = decoder::parseHexDump(data, size);
+                if (format != decoder::InputFormat::RAW)
+                {
+                    data = converted.data();
+                    size = converted.size();
+                }
+                decoder::RecordReader reader{data, size};
+                while (auto record{reader.next()})
+                {
+                    records++;
+                    if (!filter.accepts(*record) || (pendingOnly && record->uploaded))
+                        continue;
+                    selected++;
+                    writer.write(*record);
+                }
+                invalid += reader.getInvalid();
+            }
+            catch (const std::runtime_error& e)
+            {
+                fprintf(stderr, "%s\n", e.what());
+                return 1;
+            }
+        }
+    }
+    if (outputPath)
+        fclose(output);
+    if (!quiet)
+    {
+        double seconds{std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count()};
+        fprintf(stderr, "%zu records decoded (%zu selected, %zu invalid skipped) in %.3f s.\n", records, selected, invalid, seconds);
+    }
+    return 0;
+}
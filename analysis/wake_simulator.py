@@ -0,0 +1,131 @@
+"""Simulates the wake schedule of a sensor node (see SensorNode::wake in firmware/sensor_node/sensornode.cpp) and reports the amount of boots per day,
+with and without wake coalescing, along with how far samples are moved from their scheduled time.
+
+Sensors are given as INTERVAL[:OFFSET] in seconds. Sensors without an offset follow the node-wide schedule, i.e. are rounded to multiples of their
+interval. The defaults match the firmware and gateway configs:
+
+    python wake_simulator.py --sensor 1200 --sensor 1200 --sensor 21600:600 --comm-interval 3600 --comm-offset 1170
+    python wake_simulator.py --sensor 1200 --sensor 3600:30 --window 0 60 120 --days 7
+"""
+import argparse
+
+
+class Node:
+    """Mirror of the sensor node's scheduler, with all times in seconds."""
+
+    def __init__(self, sensors, comm_interval, comm_offset, comm_duration, window, wake_before_comm, sample_lead, start):
+        self.sensors = [(interval, offset) for interval, offset in sensors]
+        self.next_sample_times = [(start // interval) * interval + offset for interval, offset in self.sensors]
+        for i, (interval, _) in enumerate(self.sensors):
+            while self.next_sample_times[i] <= start:
+                self.next_sample_times[i] += interval
+        self.comm_interval = comm_interval
+        self.comm_duration = comm_duration
+        self.next_comm_time = (start // comm_interval) * comm_interval + comm_offset
+        while self.next_comm_time <= start:
+            self.next_comm_time += comm_interval
+        self.window = window
+        self.wake_before_comm = wake_before_comm
+        self.sample_lead = sample_lead
+        self.boots = 0
+        self.sample_periods = 0
+        self.comm_periods = 0
+        self.merged = 0
+        self.displacements = []
+
+    def next_sample_time(self):
+        return min(self.next_sample_times)
+
+    def sample_merged_with_comm(self):
+        merged_wake = self.next_comm_time - self.wake_before_comm - self.sample_lead
+        return abs(self.next_sample_time() - merged_wake) <= self.window
+
+    def comm_wake_time(self):
+        return self.next_comm_time - self.wake_before_comm - (self.sample_lead if self.sample_merged_with_comm() else 0)
+
+    def next_wake_time(self):
+        if self.sample_merged_with_comm():
+            return self.comm_wake_time()
+        return min(self.comm_wake_time(), self.next_sample_time())
+
+    def sample_period(self, time):
+        until = max(self.next_sample_time(), time + self.window)
+        for i, (interval, _) in enumerate(self.sensors):
+            if self.next_sample_times[i] <= until:
+                self.displacements.append(time - self.next_sample_times[i])
+                while self.next_sample_times[i] <= until:
+                    self.next_sample_times[i] += interval
+        self.sample_periods += 1
+
+    def wake(self, time):
+        """Handles a single boot at the given time.
+
+        :return: The time at which the boot ends.
+        """
+        if time >= self.comm_wake_time():
+            if self.sample_merged_with_comm():
+                self.sample_period(time)
+                self.merged += 1
+            # the comm period light sleeps until the comm time, after which the exchange with the gateway takes place
+            time = max(time, self.next_comm_time) + self.comm_duration
+            self.next_comm_time += self.comm_interval
+            self.comm_periods += 1
+        if time >= self.next_sample_time():
+            self.sample_period(time)
+        return time
+
+    def run(self, end):
+        time = self.next_wake_time()
+        while time < end:
+            self.boots += 1
+            time = self.wake(time)
+            time = max(time + 1, self.next_wake_time())
+
+
+def parse_sensor(string):
+    interval, _, offset = string.partition(":")
+    return int(interval), int(offset) if offset else None
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--sensor", type=parse_sensor, action="append", help="sensor schedule as INTERVAL[:OFFSET] in seconds, repeatable")
+    parser.add_argument("--sample-interval", type=int, default=20 * 60, help="node-wide sample interval (DEFAULT_SAMPLE_INTERVAL)")
+    parser.add_argument("--sample-offset", type=int, default=0, help="node-wide sample offset (DEFAULT_SAMPLE_OFFSET)")
+    parser.add_argument("--comm-interval", type=int, default=60 * 60, help="comm interval (DEFAULT_COMM_INTERVAL)")
+    parser.add_argument("--comm-offset", type=int, default=0, help="offset of the node's comm time within the comm interval")
+    parser.add_argument("--comm-duration", type=int, default=2, help="time from the comm time until the exchange with the gateway has ended")
+    parser.add_argument("--window", type=int, nargs="+", default=[60], help="coalescing windows to compare (WAKE_COALESCE_WINDOW)")
+    parser.add_argument("--wake-before-comm", type=int, default=3, help="WAKE_BEFORE_COMM_PERIOD")
+    parser.add_argument("--sample-lead", type=int, default=2, help="WAKE_SAMPLE_LEAD")
+    parser.add_argument("--conversion-time", type=int, default=750,
+                        help="longest sensor conversion time in ms, added to the sample lead (default: DS18B20 at SOILTEMP_RESOLUTION 12)")
+    parser.add_argument("--days", type=float, default=7)
+    args = parser.parse_args()
+
+    sensors = [(interval, args.sample_offset % interval if offset is None else offset % interval)
+               for interval, offset in (args.sensor or [(args.sample_interval, None)])]
+    start = 1_700_000_000 // 86400 * 86400
+    end = start + int(args.days * 86400)
+
+    # mirrors sampleLead() of the node
+    sample_lead = args.sample_lead + (args.conversion_time + 999) // 1000
+
+    def simulate(window):
+        node = Node(sensors, args.comm_interval, args.comm_offset, args.comm_duration, window, args.wake_before_comm, sample_lead, start)
+        node.run(end)
+        return node
+
+    baseline = simulate(0)
+    print("window (s)\tboots/day\tsaved/day\tsample periods/day\tmerged with comm/day\tmax early (s)\tmax late (s)")
+    for window in sorted(set([0] + args.window)):
+        node = baseline if window == 0 else simulate(window)
+        early = -min(node.displacements, default=0)
+        late = max(node.displacements, default=0)
+        print("{}\t{:.1f}\t{:.1f}\t{:.1f}\t{:.1f}\t{}\t{}".format(window, node.boots / args.days, (baseline.boots - node.boots) / args.days,
+                                                                 node.sample_periods / args.days, node.merged / args.days, max(early, 0),
+                                                                 max(late, 0)))
+
+
+if __name__ == "__main__":
+    main()
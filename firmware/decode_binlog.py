@@ -0,0 +1,113 @@
+"""Renders a binary log ring (see lib/Logging/src/binarylog.h) to text.
+
+The ring is read from the device with esptool, using the offset and size of the 'binlog' partition in partitions.csv:
+
+    esptool.py read_flash 0x310000 0x10000 binlog.bin
+    python decode_binlog.py binlog.bin .pio/build/gateway/firmware.elf
+
+String literals are logged by their address in flash, so the ELF file of the exact firmware that wrote the log is required to render them.
+"""
+import argparse
+import datetime
+import struct
+import sys
+
+SECTOR_SIZE = 4096
+SYNC = 0xA5
+HEADER_LENGTH = 7
+LEVELS = {0: "DEBUG", 1: "INFO", 2: "ERROR"}
+
+
+class ElfStrings:
+    """Resolves addresses of string literals using the allocated sections of a 32-bit little-endian ELF file."""
+
+    def __init__(self, path):
+        with open(path, "rb") as f:
+            self.data = f.read()
+        if self.data[:4] != b"\x7fELF" or self.data[4] != 1:
+            raise ValueError(f"{path} is not a 32-bit ELF file")
+        e_shoff, = struct.unpack_from("<I", self.data, 0x20)
+        e_shentsize, e_shnum = struct.unpack_from("<HH", self.data, 0x2E)
+        self.sections = []
+        for i in range(e_shnum):
+            _, sh_type, sh_flags, sh_addr, sh_offset, sh_size = struct.unpack_from("<IIIIII", self.data, e_shoff + i * e_shentsize)
+            # allocated sections with contents in the file (i.e. not .bss)
+            if sh_flags & 0x2 and sh_type != 8 and sh_addr != 0:
+                self.sections.append((sh_addr, sh_offset, sh_size))
+
+    def resolve(self, address):
+        for sh_addr, sh_offset, sh_size in self.sections:
+            if sh_addr <= address < sh_addr + sh_size:
+                start = sh_offset + address - sh_addr
+                end = self.data.index(b"\0", start)
+                return self.data[start:end].decode(errors="replace")
+        return None
+
+
+def render_arguments(payload, strings):
+    text = []
+    i = 0
+    while i < len(payload):
+        kind = chr(payload[i])
+        i += 1
+        if kind == "P":
+            address, = struct.unpack_from("<I", payload, i)
+            i += 4
+            string = strings.resolve(address) if strings else None
+            text.append(string if string is not None else f"<0x{address:08X}>")
+        elif kind == "S":
+            length = payload[i]
+            text.append(payload[i + 1:i + 1 + length].decode(errors="replace"))
+            i += 1 + length
+        elif kind == "i":
+            text.append(str(struct.unpack_from("<i", payload, i)[0]))
+            i += 4
+        elif kind == "u":
+            text.append(str(struct.unpack_from("<I", payload, i)[0]))
+            i += 4
+        elif kind == "f":
+            text.append(f"{struct.unpack_from('<f', payload, i)[0]:f}")
+            i += 4
+        elif kind == "c":
+            text.append(chr(payload[i]))
+            i += 1
+        else:
+            text.append(f"<unknown argument kind 0x{payload[i - 1]:02X}>")
+            break
+    return "".join(text)
+
+
+def read_records(ring):
+    """Yields (time, level, payload) for all records in the ring, oldest sector first."""
+    sectors = []
+    for offset in range(0, len(ring) - len(ring) % SECTOR_SIZE, SECTOR_SIZE):
+        sequence, = struct.unpack_from("<I", ring, offset)
+        if sequence != 0xFFFFFFFF:
+            sectors.append((sequence, offset))
+    for _, offset in sorted(sectors):
+        i = offset + 4
+        end = offset + SECTOR_SIZE
+        while i + HEADER_LENGTH <= end and ring[i] == SYNC:
+            length = ring[i + 1]
+            if length < HEADER_LENGTH or i + length > end:
+                break
+            time, level = struct.unpack_from("<IB", ring, i + 2)
+            yield time, level, ring[i + HEADER_LENGTH:i + length]
+            i += length
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("ring", help="dump of the binlog partition")
+    parser.add_argument("elf", nargs="?", help="ELF file of the firmware that wrote the log")
+    args = parser.parse_args()
+    strings = ElfStrings(args.elf) if args.elf else None
+    with open(args.ring, "rb") as f:
+        ring = f.read()
+    for time, level, payload in read_records(ring):
+        timestamp = datetime.datetime.fromtimestamp(time, datetime.timezone.utc).strftime("%Y-%m-%d %H:%M:%S")
+        sys.stdout.write(f"[{timestamp}]{LEVELS.get(level, 'NONE')}: {render_arguments(payload, strings)}\n")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,154 @@
+"""Retrieves a file from a module in command phase over UART using the 'export' command, which streams the file in CRC-checked binary frames.
+
+Corrupted or missing frames are requested again from the first missing offset, so an interrupted export resumes instead of restarting:
+
+    python export_file.py /dev/ttyUSB0 /data.dat -o data.dat --baud 921600
+    python export_file.py /dev/ttyUSB0 /data.dat -o data.dat --decode > data.csv
+
+With --decode, the sensor data records of the file (see MIRRAModule::storeSensorData) are written to stdout as CSV. Requires pyserial.
+"""
+import argparse
+import struct
+import sys
+import time
+import zlib
+
+import serial
+
+SYNC = b"MX"
+FRAME_HEADER = struct.Struct("<cIH")
+CRC = struct.Struct("<I")
+MAX_FRAME_LENGTH = 4096
+COMMAND_BAUD = 115200
+
+
+class FrameReader:
+    """Extracts frames from a serial stream, skipping anything that is not a valid frame (e.g. the echoed command or corrupted frames)."""
+
+    def __init__(self, port):
+        self.port = port
+        self.buffer = b""
+
+    def read(self, timeout):
+        """Returns the next valid frame as (type, offset, data), or None on timeout."""
+        deadline = time.monotonic() + timeout
+        while True:
+            frame = self.parse()
+            if frame is not None:
+                return frame
+            if time.monotonic() >= deadline:
+                return None
+            self.buffer += self.port.read(self.port.in_waiting or 1)
+
+    def parse(self):
+        while True:
+            start = self.buffer.find(SYNC)
+            if start < 0:
+                self.buffer = self.buffer[-1:]
+                return None
+            self.buffer = self.buffer[start:]
+            header_end = len(SYNC) + FRAME_HEADER.size
+            if len(self.buffer) < header_end:
+                return None
+            kind, offset, length = FRAME_HEADER.unpack_from(self.buffer, len(SYNC))
+            if length > MAX_FRAME_LENGTH:
+                self.buffer = self.buffer[1:]
+                continue
+            end = header_end + length + CRC.size
+            if len(self.buffer) < end:
+                return None
+            crc, = CRC.unpack_from(self.buffer, header_end + length)
+            if zlib.crc32(self.buffer[len(SYNC):header_end + length]) != crc:
+                self.buffer = self.buffer[1:]
+                continue
+            data = self.buffer[header_end:header_end + length]
+            self.buffer = self.buffer[end:]
+            return kind, offset, data
+
+
+def export(port, filename, baud, attempts, timeout):
+    """Returns the contents of the file on the module, requesting it again from the first missing offset after errors."""
+    contents = bytearray()
+    size = None
+    for attempt in range(attempts):
+        port.baudrate = COMMAND_BAUD
+        port.reset_input_buffer()
+        port.write(f"export {filename} {len(contents)} {baud}\n".encode())
+        reader = FrameReader(port)
+        frame = reader.read(timeout)
+        if frame is None or frame[0] != b"H":
+            sys.stderr.write(f"No export header received (attempt {attempt + 1}): {reader.buffer.decode(errors='replace').strip()}\n")
+            continue
+        size, block_size, export_baud = struct.unpack("<IHI", frame[2])
+        if export_baud != COMMAND_BAUD:
+            port.baudrate = export_baud
+        while True:
+            frame = reader.read(timeout)
+            if frame is None:
+                sys.stderr.write(f"Export timed out at offset {len(contents)} of {size}, resuming\n")
+                break
+            kind, offset, data = frame
+            if kind == b"B" and offset == len(contents):
+                contents += data
+            elif kind == b"B":
+                # a frame was lost, ignore the remainder of this export and resume from the gap
+                sys.stderr.write(f"Frame at offset {len(contents)} lost, resuming\n")
+                break
+            elif kind == b"E":
+                break
+        if len(contents) == size:
+            port.baudrate = COMMAND_BAUD
+            # drain the remainder of an aborted export at the export baud rate
+            time.sleep(0.2)
+            port.reset_input_buffer()
+            return bytes(contents)
+        # wait for the module to finish the aborted export and return to the command baud rate
+        time.sleep(max(timeout, (size - len(contents)) * 10 / export_baud))
+    raise RuntimeError(f"could not export {filename} in {attempts} attempts ({len(contents)} of {size} bytes)")
+
+
+def decode_records(contents):
+    """Yields the sensor data records of a data file as (uploaded, source, destination, sequence, time, values), with values as (tag, value) tuples."""
+    i = 0
+    while i < len(contents):
+        size = contents[i]
+        record = contents[i + 1:i + 1 + size]
+        i += 1 + size
+        if len(record) < 20:
+            break
+        n_values = record[19]
+        values = [struct.unpack_from("<Hf", record, 20 + j * 6) for j in range(n_values) if 20 + (j + 1) * 6 <= len(record)]
+        sequence, timestamp = struct.unpack_from("<HI", record, 13)
+        yield record[0], record[1:7], record[7:13], sequence, timestamp, values
+
+
+def format_mac(mac):
+    return ":".join(f"{b:02X}" for b in mac)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("port", help="serial port of the module")
+    parser.add_argument("filename", help="file to export, including slashes (e.g. /data.dat)")
+    parser.add_argument("-o", "--output", help="file to write the exported contents to")
+    parser.add_argument("--baud", type=int, default=0, help="baud rate to transfer the file at (default: keep 115200)")
+    parser.add_argument("--decode", action="store_true", help="write the sensor data records of the file to stdout as CSV")
+    parser.add_argument("--attempts", type=int, default=5, help="maximum amount of (resumed) export attempts")
+    parser.add_argument("--timeout", type=float, default=3, help="time to wait for a frame in seconds")
+    args = parser.parse_args()
+    with serial.Serial(args.port, COMMAND_BAUD, timeout=0.1) as port:
+        start = time.monotonic()
+        contents = export(port, args.filename, args.baud, args.attempts, args.timeout)
+        sys.stderr.write(f"Exported {len(contents)} bytes in {time.monotonic() - start:.1f} s\n")
+    if args.output:
+        with open(args.output, "wb") as f:
+            f.write(contents)
+    if args.decode:
+        sys.stdout.write("source,destination,sequence,time,uploaded,type,instance,value\n")
+        for uploaded, source, destination, sequence, timestamp, values in decode_records(contents):
+            for tag, value in values:
+                sys.stdout.write(f"{format_mac(source)},{format_mac(destination)},{sequence},{timestamp},{uploaded},{tag >> 4},{tag & 0xF},{value}\n")
+
+
+if __name__ == "__main__":
+    main()
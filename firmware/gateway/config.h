@@ -34,14 +34,30 @@
 #define WIFI_SSID "GontrodeWiFi2"
 #define WIFI_PASS "b5uJeswA"
 #define NTP_URL "be.pool.ntp.org"
+#define WIFI_TIMEOUT 10000              // ms, time to wait for a full WiFi connection (scan, association and DHCP)
+#define WIFI_FAST_TIMEOUT 2000          // ms, time to wait for a fast WiFi reconnect using the cached BSSID, channel and IP lease
+#define WIFI_CACHE_LIFETIME (24 * 60 * 60) // s, maximum time the cached IP lease is reused, if the DHCP server's renewal time (T1) is longer
 
 // MQTT settings
+#ifndef MQTT_SERVER // can be overridden with a build flag, e.g. to test against a local broker
 #define MQTT_SERVER IPAddress(5, 9, 199, 28)
+#endif
+#ifndef MQTT_PORT
 #define MQTT_PORT 1883
+#endif
 #define TOPIC_PREFIX "fornalab" // MQTT topic = `TOPIC_PREFIX` + '/' + `GATEWAY MAC` + '/' + `SENSOR MODULE MAC`
 #define MQTT_ATTEMPTS 5         // amount of attempts made to connect to MQTT server
 #define MQTT_TIMEOUT 1000       // ms, timeout to connect with MQTT server
 #define MAX_MQTT_ERRORS 3       // max number of MQTT publish errors after which uploading should be aborted
+#define MQTT_BUFFER_SIZE 2048   // bytes, bounds the size of a single batched publish
+#define MQTT_ACK_TIMEOUT 5000   // ms, time to wait for outstanding publish acknowledgements at the end of an upload
+
+// Uplink task settings: the upload runs in a separate task, overlapping with the comm period that runs on the Arduino core (1)
+#define UPLINK_CORE 0            // core the uplink task is pinned to
+#define UPLINK_TASK_STACK 8192   // bytes
+#define UPLINK_TASK_PRIORITY 1
+#define UPLINK_QUEUE_SIZE 256    // max amount of stored records queued at once for the uplink task, refilled until the backlog is uploaded, must be a power of two
+#define UPLINK_POLL_INTERVAL 50  // ms, time the uplink task waits for new records when the queue is empty
 
 // Communication and sensor settings
 
@@ -54,11 +70,17 @@
 #define WAKE_COMM_PERIOD(X) ((X)-WAKE_BEFORE_COMM_PERIOD)
 #define LISTEN_COMM_PERIOD(X) ((X)-COMM_PERIOD_PADDING)
 
-#define UPLOAD_EVERY 3 // amount of times the gateway will communicate with the nodes before uploading data to the server
+// Upload policy: the gateway uploads when the backlog of stored records amortises the expected WiFi connect time, or when it grows too old or large
+#define UPLOAD_MAX_DELAY (6 * 60 * 60)   // s, max age of the oldest record not yet uploaded
+#define UPLOAD_MAX_BACKLOG (32 * 1024)   // bytes, backlog above which an upload is always started, well below MAX_SENSORDATA_FILESIZE
+#define UPLOAD_BYTES_PER_CONNECT_MS 1    // bytes of backlog required per ms of expected WiFi connect time
+#define UPLOAD_BACKOFF_BASE (5 * 60)     // s, time to wait after a failed upload, doubled for every subsequent failure
+#define UPLOAD_BACKOFF_MAX (6 * 60 * 60) // s, max time to wait after failed uploads
 
 #define DEFAULT_SAMPLE_INTERVAL (20 * 60) // s, time between sensor sampling for every node
 #define DEFAULT_SAMPLE_ROUNDING (20 * 60) // s, round sampling time to nearest ...
 #define DEFAULT_SAMPLE_OFFSET (0)
+#define MAX_SENSOR_SCHEDULES 8 // per-sensor sampling schedules stored per node, see the sensorschedule command
 
 #define DISCOVERY_TIMEOUT 5000 // ms
 
@@ -72,4 +94,6 @@
 
 #define MAX_SENSOR_NODES 20
 
+#define TELEMETRY_INTERVAL (6 * 60 * 60) // s, interval at which phase timing telemetry is stored along with the sensor data
+
 #endif
@@ -1,6 +1,9 @@
 #include "gateway.h"
 #include "esp_netif.h"
+#include "esp_netif_net_stack.h"
+#include "lwip/dhcp.h"
 #include "esp_sntp.h"
+#include <array>
 #include <cstring>
 
 void Node::timeConfig(Message<TIME_CONFIG>& m)
@@ -23,11 +26,298 @@ void Node::naiveTimeConfig(uint32_t cTime)
     this->errors++;
 }
 
+bool Node::acceptSequence(uint16_t sequence)
+{
+    int16_t delta{static_cast<int16_t>(sequence - this->lastSequence)};
+    if (this->sequenceWindow == 0 || delta >= static_cast<int16_t>(sequenceWindowSize) || -delta >= static_cast<int16_t>(sequenceWindowSize))
+    {
+        // first record, or too far ahead/behind to relate to the window: (re)synchronise
+        this->lastSequence = sequence;
+        this->sequenceWindow = 1;
+        return true;
+    }
+    if (delta > 0)
+    {
+        this->lastSequence = sequence;
+        this->sequenceWindow = (this->sequenceWindow << delta) | 1;
+        return true;
+    }
+    uint32_t bit{1u << -delta};
+    if (this->sequenceWindow & bit)
+        return false;
+    this->sequenceWindow |= bit;
+    return true;
+}
+
+bool Node::receivedBetween(uint16_t from, uint16_t to) const
+{
+    uint16_t span{static_cast<uint16_t>(to - from)};
+    uint16_t age{static_cast<uint16_t>(this->lastSequence - from)};
+    if (this->sequenceWindow == 0 || age >= sequenceWindowSize || span > age)
+        return false;
+    for (uint16_t sequence{static_cast<uint16_t>(from + 1)}; sequence != to; sequence++)
+    {
+        // skipped by the node
+        if (sequence == Message<SENSOR_DATA>::filledSequence)
+            continue;
+        if (!(this->sequenceWindow & (1u << static_cast<uint16_t>(this->lastSequence - sequence))))
+            return false;
+    }
+    return true;
+}
+
+void Node::scheduleChanged(uint16_t tag)
+{
+    // the values received so far were taken under the previous schedule, so gaps are no longer filled from them
+    this->reportedValues.clearType(tag >> 4);
+    this->schedulesPending = true;
+}
+
+bool Node::setSchedule(uint16_t tag, uint32_t interval, uint32_t offset)
+{
+    auto end{this->schedules.begin() + this->nSchedules};
+    auto existing{std::find_if(this->schedules.begin(), end, [&](const SensorSchedule& s) { return s.appliesTo(tag >> 4); })};
+    if (interval == 0)
+    {
+        if (existing == end)
+            return true;
+        std::copy(existing + 1, end, existing);
+        this->nSchedules--;
+    }
+    else if (existing != end)
+    {
+        existing->interval = interval;
+        existing->offset = offset % interval;
+    }
+    else if (this->nSchedules < this->schedules.size())
+    {
+        this->schedules[this->nSchedules++] = SensorSchedule{tag, interval, offset % interval};
+    }
+    else
+    {
+        return false;
+    }
+    scheduleChanged(tag);
+    return true;
+}
+
+bool Node::setReadInterval(uint16_t tag, uint32_t readInterval)
+{
+    auto end{this->schedules.begin() + this->nSchedules};
+    auto existing{std::find_if(this->schedules.begin(), end, [&](const SensorSchedule& s) { return s.appliesTo(tag >> 4); })};
+    if (existing != end)
+    {
+        existing->readInterval = readInterval;
+    }
+    else if (readInterval == 0)
+    {
+        return true;
+    }
+    else if (this->nSchedules < this->schedules.size())
+    {
+        // the sensor keeps the node's sample interval, aligned to multiples of it
+        this->schedules[this->nSchedules++] = SensorSchedule{tag, this->sampleInterval, this->sampleOffset % this->sampleInterval, readInterval};
+    }
+    else
+    {
+        return false;
+    }
+    scheduleChanged(tag);
+    return true;
+}
+
+bool Node::setDeadBand(uint16_t tag, float deadBand, uint32_t maxSilence)
+{
+    auto end{this->schedules.begin() + this->nSchedules};
+    auto existing{std::find_if(this->schedules.begin(), end, [&](const SensorSchedule& s) { return s.appliesTo(tag >> 4); })};
+    if (existing != end)
+    {
+        existing->deadBand = deadBand;
+        existing->maxSilence = maxSilence;
+    }
+    else if (deadBand == 0)
+    {
+        return true;
+    }
+    else if (this->nSchedules < this->schedules.size())
+    {
+        SensorSchedule schedule{tag, this->sampleInterval, this->sampleOffset % this->sampleInterval};
+        schedule.deadBand = deadBand;
+        schedule.maxSilence = maxSilence;
+        this->schedules[this->nSchedules++] = schedule;
+    }
+    else
+    {
+        return false;
+    }
+    scheduleChanged(tag);
+    return true;
+}
+
+void Node::fillDeadBandGaps(Message<SENSOR_DATA>& m, const MACAddress& gatewayMAC, std::vector<Message<SENSOR_DATA>>& data)
+{
+    auto end{this->schedules.begin() + this->nSchedules};
+    std::vector<std::pair<uint32_t, SensorValue>> fills;
+    for (size_t i{0}; i < m.getNValues(); i++)
+    {
+        const SensorValue value{m.getValues()[i]};
+        auto schedule{std::find_if(this->schedules.begin(), end, [&](const SensorSchedule& s) { return s.appliesTo(value.tag >> 4); })};
+        if (schedule == end || !schedule->isDeadBanded())
+            continue;
+        auto* last{this->reportedValues.find(value.tag)};
+        // a record that was retransmitted after a newer one
+        if (last && m.getCTime() <= last->time)
+            continue;
+        // a gap spanning a record that has not been received is left as is, as that record may still arrive with the actual values
+        if (last && receivedBetween(last->sequence, m.getSequence()))
+        {
+            for (uint32_t time{last->time + schedule->interval}; time + schedule->interval / 2 < m.getCTime() && time - last->time < schedule->maxSilence;
+                 time += schedule->interval)
+                fills.emplace_back(time, SensorValue(value.tag, last->value));
+        }
+        this->reportedValues.set(value, m.getCTime(), m.getSequence());
+    }
+    if (fills.empty())
+        return;
+    Log::debug("Filling in ", fills.size(), " values left out by ", this->mac, ".");
+    // values filled in for the same time share a record
+    std::stable_sort(fills.begin(), fills.end(), [](const auto& a, const auto& b) { return a.first < b.first; });
+    std::array<SensorValue, Message<SENSOR_DATA>::maxNValues> values;
+    uint8_t nValues{0};
+    for (size_t i{0}; i < fills.size(); i++)
+    {
+        values[nValues++] = fills[i].second;
+        if (i + 1 == fills.size() || fills[i + 1].first != fills[i].first || nValues == values.size())
+        {
+            data.emplace_back(this->mac, gatewayMAC, Message<SENSOR_DATA>::filledSequence, fills[i].first, nValues, values);
+            nValues = 0;
+        }
+    }
+}
+
+void Node::inheritSchedules(const Node& previous)
+{
+    this->schedules = previous.schedules;
+    this->nSchedules = previous.nSchedules;
+    this->schedulesPending = previous.nSchedules > 0;
+}
+
+uint32_t Node::getShortestSampleInterval() const
+{
+    uint32_t shortest{this->sampleInterval};
+    for (size_t i{0}; i < this->nSchedules; i++)
+        shortest = std::min(shortest, this->schedules[i].interval);
+    return shortest;
+}
+
+void LinkStats::recordFrame(const LinkMetrics& metrics)
+{
+    if (rssi == 0) // no frame recorded yet
+    {
+        rssi = metrics.rssi;
+        snr = metrics.snr;
+        frequencyError = metrics.frequencyError;
+    }
+    else
+    {
+        rssi += weight * (metrics.rssi - rssi);
+        snr += weight * (metrics.snr - snr);
+        frequencyError += weight * (metrics.frequencyError - frequencyError);
+    }
+    frames++;
+}
+
+void LinkStats::recordCommPeriod(const LinkCounters& start, const LinkCounters& end)
+{
+    uint32_t received{end.framesReceived - start.framesReceived};
+    uint32_t periodLost{(end.timeouts - start.timeouts) + (end.crcErrors - start.crcErrors)};
+    lost += periodLost;
+    repeats += end.repeatsSent - start.repeatsSent;
+    retransmissions += end.retransmissions - start.retransmissions;
+    if (received + periodLost > 0)
+        lossRate += weight * (static_cast<float>(periodLost) / (received + periodLost) - lossRate);
+}
+
+size_t LinkStats::emit(SensorValue* values)
+{
+    values[0] = SensorValue(LINK_STATS_TYPE, 0, rssi);
+    values[1] = SensorValue(LINK_STATS_TYPE, 1, snr);
+    values[2] = SensorValue(LINK_STATS_TYPE, 2, frequencyError);
+    values[3] = SensorValue(LINK_STATS_TYPE, 3, lossRate);
+    values[4] = SensorValue(LINK_STATS_TYPE, 4, static_cast<float>(frames));
+    values[5] = SensorValue(LINK_STATS_TYPE, 5, static_cast<float>(lost));
+    values[6] = SensorValue(LINK_STATS_TYPE, 6, static_cast<float>(repeats));
+    values[7] = SensorValue(LINK_STATS_TYPE, 7, static_cast<float>(retransmissions));
+    frames = lost = repeats = retransmissions = 0;
+    return 8;
+}
+
+void UploadBatch::add(const uint8_t* record, uint8_t length, size_t flagPosition, size_t storedSize)
+{
+    SensorDataBatch::append(payload, record, length);
+    flagPositions.push_back(flagPosition);
+    storedBytes += storedSize;
+}
+
+void UploadBatch::clear()
+{
+    SensorDataBatch::begin(payload);
+    flagPositions.clear();
+    storedBytes = 0;
+}
+
+void UploadPolicy::recordStored(uint32_t bytes, uint32_t sampleTime)
+{
+    if (pendingBytes == 0 || sampleTime < oldestPending)
+        oldestPending = sampleTime;
+    pendingBytes += bytes;
+}
+
+bool UploadPolicy::shouldUpload(uint32_t cTime, uint32_t expectedConnectMs) const
+{
+    if (pendingBytes == 0 || cTime < backoffUntil)
+        return false;
+    if (cTime - oldestPending >= UPLOAD_MAX_DELAY || pendingBytes >= UPLOAD_MAX_BACKLOG)
+        return true;
+    return pendingBytes >= UPLOAD_BYTES_PER_CONNECT_MS * expectedConnectMs;
+}
+
+void UploadPolicy::uploadFinished(bool success, uint32_t cTime)
+{
+    if (success)
+    {
+        consecutiveFailures = 0;
+        backoffUntil = 0;
+        return;
+    }
+    consecutiveFailures++;
+    uint32_t backoff{UPLOAD_BACKOFF_MAX};
+    if (consecutiveFailures <= 16)
+        backoff = std::min<uint32_t>(UPLOAD_BACKOFF_BASE << (consecutiveFailures - 1), UPLOAD_BACKOFF_MAX);
+    backoffUntil = cTime + backoff;
+}
+
+void WiFiConnectStats::record(uint32_t latency, bool fastPath)
+{
+    auto& histogram{fastPath ? fast : full};
+    size_t bucket{0};
+    while (bucket < bounds.size() && latency > bounds[bucket])
+        bucket++;
+    histogram[bucket]++;
+    lastLatency = latency;
+    averageLatency = averageLatency == 0 ? latency : (3 * averageLatency + latency) / 4;
+}
+
 RTC_DATA_ATTR bool initialBoot{true};
-RTC_DATA_ATTR int commPeriods{0};
+RTC_DATA_ATTR UploadPolicy uploadPolicy;
+RTC_DATA_ATTR UploadStats uploadStats;
+RTC_DATA_ATTR uint16_t telemetrySequence{0};
+RTC_DATA_ATTR uint32_t nextTelemetryTime{0};
 
 RTC_DATA_ATTR char ssid[32]{WIFI_SSID};
 RTC_DATA_ATTR char pass[32]{WIFI_PASS};
+RTC_DATA_ATTR WiFiCache wifiCache;
+RTC_DATA_ATTR WiFiConnectStats wifiStats;
 
 RTC_DATA_ATTR uint32_t defaultSampleInterval{DEFAULT_SAMPLE_INTERVAL};
 RTC_DATA_ATTR uint32_t defaultSampleRounding{DEFAULT_SAMPLE_ROUNDING};
@@ -44,7 +334,7 @@ RTC_DATA_ATTR uint32_t commInterval{DEFAULT_COMM_INTERVAL};
 
 auto lambdaIsLost = [](const Node& e) { return e.getCommInterval() != commInterval; };
 
-Gateway::Gateway(const MIRRAPins& pins) : MIRRAModule(pins), mqttClient{WiFiClient()}, mqtt{PubSubClient(MQTT_SERVER, MQTT_PORT, mqttClient)}
+Gateway::Gateway(const MIRRAPins& pins) : MIRRAModule(pins), mqttClient{WiFiClient()}, mqtt{mqttClient, MQTT_SERVER, MQTT_PORT}
 {
     if (initialBoot)
     {
@@ -58,6 +348,7 @@ Gateway::Gateway(const MIRRAPins& pins) : MIRRAModule(pins), mqttClient{WiFiClie
         }
 
         Commands(this).rtcUpdateTime();
+        scanPending();
         initialBoot = false;
     }
     nodesFromFile();
@@ -66,15 +357,33 @@ Gateway::Gateway(const MIRRAPins& pins) : MIRRAModule(pins), mqttClient{WiFiClie
 void Gateway::wake()
 {
     Log::debug("Running wake()...");
-    if (!nodes.empty() && rtc.getSysTime() >= (WAKE_COMM_PERIOD(nodes[0].getNextCommTime()) - 3))
+    bool commDue{!nodes.empty() && rtc.getSysTime() >= (WAKE_COMM_PERIOD(nodes[0].getNextCommTime()) - 3)};
+    // upload on the other core while the comm period runs, data received during the comm period is uploaded along
+    if (uploadPolicy.shouldUpload(rtc.getSysTime(), wifiStats.averageLatency))
+        startUplink();
+    else
+        Log::debug("Upload deferred with ", uploadPolicy.pendingBytes, " bytes pending.");
+    if (commDue)
         commPeriod();
-    // send data to server only every UPLOAD_EVERY comm periods
-    if (commPeriods >= UPLOAD_EVERY)
+    finishUplink();
+    uint32_t cTime{rtc.getSysTime()};
+    if (cTime >= nextTelemetryTime)
+    {
+        Log::debug("Storing phase timing telemetry...");
+        std::vector<Message<SENSOR_DATA>> telemetry{phaseTimingMessage(lora.getMACAddress(), telemetrySequence++, cTime)};
+        for (Node& n : nodes)
+            telemetry.push_back(linkStatsMessage(n, telemetrySequence++, cTime));
+        storeSensorData(telemetry);
+        if (!nodes.empty())
+            updateNodesFile();
+        nextTelemetryTime = cTime + TELEMETRY_INTERVAL;
+    }
+    if (commandEntry.isRequested())
     {
-        uploadPeriod();
+        Serial.printf("Welcome! This is Gateway %s\n", lora.getMACAddress().toString());
+        PhaseTiming::Scope timing{PHASE_COMMAND};
+        commandEntry.prompt(Commands(this));
     }
-    Serial.printf("Welcome! This is Gateway %s\n", lora.getMACAddress().toString());
-    commandEntry.prompt(Commands(this));
     Log::debug("Entering deep sleep...");
     if (nodes.empty())
         deepSleep(commInterval);
@@ -110,7 +419,7 @@ void Gateway::discovery()
         Log::error("Error while awaiting/receiving reply to discovery message. Aborting discovery.");
         return;
     }
-    Log::info("Node found at ", helloReply->getSource().toString());
+    Log::info("Node found at ", helloReply->getSource());
 
     uint32_t cTime{rtc.getSysTime()};
     uint32_t sampleInterval{defaultSampleInterval}, sampleRounding{defaultSampleRounding}, sampleOffset{defaultSampleOffset};
@@ -127,17 +436,29 @@ void Gateway::discovery()
                                     MAX_MESSAGES(commInterval, sampleInterval)};
     Log::debug("Time config constructed. cTime = ", cTime, " sampleInterval = ", sampleInterval, " sampleRounding = ", sampleRounding,
                " sampleOffset = ", sampleOffset, " commInterval = ", commInterval, " comTime = ", commTime);
-    Log::debug("Sending time config message to ", helloReply->getSource().toString());
+    Log::debug("Sending time config message to ", helloReply->getSource());
     lora.sendMessage(timeConfig);
     auto time_ack{lora.receiveMessage<ACK_TIME>(TIME_CONFIG_TIMEOUT, TIME_CONFIG_ATTEMPTS, helloReply->getSource())};
     if (!time_ack)
     {
-        Log::error("Error while receiving ack to time config message from ", helloReply->getSource().toString(), ". Aborting discovery.");
+        Log::error("Error while receiving ack to time config message from ", helloReply->getSource(), ". Aborting discovery.");
         return;
     }
 
-    Log::info("Registering node ", time_ack->getSource().toString());
-    nodes.emplace_back(timeConfig);
+    Log::info("Registering node ", time_ack->getSource());
+    // a node that is rediscovered has been reset, so its old entry (and sequence window) is replaced, and its sensor schedules are sent again
+    auto existing{std::find_if(nodes.begin(), nodes.end(), [&](const Node& n) { return n.getMACAddress() == time_ack->getSource(); })};
+    if (existing != nodes.end())
+    {
+        Node node{timeConfig};
+        node.inheritSchedules(*existing);
+        *existing = node;
+    }
+    else
+    {
+        existing = nodes.emplace(nodes.end(), timeConfig);
+    }
+    sendSensorConfig(*existing);
     updateNodesFile();
 }
 
@@ -145,17 +466,33 @@ void Gateway::nodesFromFile()
 {
     Log::debug("Recovering nodes from file...");
     File nodesFile{LittleFS.open(NODES_FP)};
-    uint8_t size{nodesFile.read()};
-    Log::debug(size, " nodes found in ", NODES_FP);
-    nodes.resize(size);
-    nodesFile.read((uint8_t*)nodes.data(), static_cast<size_t>(size) * sizeof(Node));
+    NodesFileHeader header{};
+    if (nodesFile.read((uint8_t*)&header, sizeof(header)) != sizeof(header) || header.version != NodesFileHeader::currentVersion ||
+        header.nodeSize != sizeof(Node))
+    {
+        // the layout of Node has changed since the file was written, so its contents can not be interpreted
+        Log::error("Nodes file ", NODES_FP, " is missing or of another firmware version, discarding the stored nodes.");
+        nodesFile.close();
+        nodes.clear();
+        updateNodesFile();
+        return;
+    }
+    Log::debug(header.nNodes, " nodes found in ", NODES_FP);
+    nodes.resize(header.nNodes);
+    size_t length{static_cast<size_t>(header.nNodes) * sizeof(Node)};
+    if (nodesFile.read((uint8_t*)nodes.data(), length) != length)
+    {
+        Log::error("Nodes file ", NODES_FP, " is truncated, discarding the stored nodes.");
+        nodes.clear();
+    }
     nodesFile.close();
 }
 
 void Gateway::updateNodesFile()
 {
     File nodesFile = LittleFS.open(NODES_FP, "w", true);
-    nodesFile.write(nodes.size());
+    NodesFileHeader header{NodesFileHeader::currentVersion, sizeof(Node), static_cast<uint8_t>(nodes.size())};
+    nodesFile.write((uint8_t*)&header, sizeof(header));
     nodesFile.write((uint8_t*)nodes.data(), nodes.size() * sizeof(Node));
     nodesFile.close();
 }
@@ -175,9 +512,15 @@ void Gateway::commPeriod()
     {
         if (n.getNextCommTime() > farCommTime)
             break;
-        farCommTime = n.getNextCommTime() + 2 * (COMM_PERIOD_LENGTH(MAX_MESSAGES(commInterval, n.getSampleInterval())) + COMM_PERIOD_PADDING);
-        if (!nodeCommPeriod(n, data))
+        farCommTime = n.getNextCommTime() + 2 * (COMM_PERIOD_LENGTH(MAX_MESSAGES(commInterval, n.getShortestSampleInterval())) + COMM_PERIOD_PADDING);
+        const uint8_t* mac{n.getMACAddress().getAddress()};
+        Trace::record(TRACE_COMM_BEGIN, mac[4] << 8 | mac[5]);
+        bool success{nodeCommPeriod(n, data)};
+        Trace::record(TRACE_COMM_END, success);
+        if (!success)
             n.naiveTimeConfig(rtc.getSysTime());
+        // store per node, so the uplink task can upload this node's data during the remainder of the comm period
+        storeSensorData(data);
     }
     std::sort(nodes.begin(), nodes.end(), lambdaByNextCommTime);
     if (nodes.empty())
@@ -188,13 +531,34 @@ void Gateway::commPeriod()
     {
         updateNodesFile();
     }
-    File dataFile = LittleFS.open(DATA_FP, "a");
-    for (Message<SENSOR_DATA>& m : data)
+}
+
+Message<SENSOR_DATA> Gateway::linkStatsMessage(Node& n, uint16_t sequence, uint32_t time)
+{
+    std::array<SensorValue, Message<SENSOR_DATA>::maxNValues> values;
+    size_t nValues{n.getLinkStats().emit(values.data())};
+    return Message<SENSOR_DATA>(n.getMACAddress(), lora.getMACAddress(), sequence, time, static_cast<uint8_t>(nValues), values);
+}
+
+void Gateway::storeSensorData(std::vector<Message<SENSOR_DATA>>& data)
+{
+    if (data.empty())
+        return;
     {
-        storeSensorData(m, dataFile);
+        std::lock_guard<std::mutex> lock{dataFileMutex};
+        File dataFile = LittleFS.open(DATA_FP, "a");
+        for (Message<SENSOR_DATA>& m : data)
+        {
+            RecordRef ref{static_cast<uint32_t>(dataFile.size() + 1), static_cast<uint8_t>(m.getLength())};
+            MIRRAModule::storeSensorData(m, dataFile);
+            uploadPolicy.recordStored(1 + ref.size, m.getCTime());
+            // once a record has been deferred, later ones are queued in file order by queuePending
+            if (uplinkRunning && uplinkDeferredFrom == NO_DEFERRED_RECORDS && !uplinkQueue.push(ref))
+                uplinkDeferredFrom = ref.flagPosition - 1;
+        }
+        dataFile.close();
     }
-    dataFile.close();
-    commPeriods++;
+    data.clear();
 }
 
 uint32_t Gateway::nextScheduledCommTime()
@@ -214,38 +578,48 @@ bool Gateway::nodeCommPeriod(Node& n, std::vector<Message<SENSOR_DATA>>& data)
     uint32_t cTime{rtc.getSysTime()};
     if (cTime > n.getNextCommTime())
     {
-        Log::error("Node ", n.getMACAddress().toString(),
+        Log::error("Node ", n.getMACAddress(),
                    "'s comm time was faultily scheduled before this gateway's comm period. Skipping communication with this node.");
         return false;
     }
     lightSleepUntil(LISTEN_COMM_PERIOD(n.getNextCommTime())); // light sleep until scheduled comm period
     uint32_t listenMs{COMM_PERIOD_PADDING * 1000};            // pre-listen in anticipation of message
     size_t messagesReceived{0};
+    LinkCounters linkStart{lora.getLinkCounters()};
+    auto recordCommPeriod = [&]() { n.getLinkStats().recordCommPeriod(linkStart, lora.getLinkCounters()); };
     while (true)
     {
-        Log::debug("Awaiting data from ", n.getMACAddress().toString(), " ...");
+        Log::debug("Awaiting data from ", n.getMACAddress(), " ...");
         auto sensorData{lora.receiveMessage<SENSOR_DATA>(SENSOR_DATA_TIMEOUT, SENSOR_DATA_ATTEMPTS, n.getMACAddress(), listenMs)};
         listenMs = 0;
         if (!sensorData)
         {
-            Log::error("Error while awaiting/receiving data from ", n.getMACAddress().toString(), ". Skipping communication with this node.");
+            Log::error("Error while awaiting/receiving data from ", n.getMACAddress(), ". Skipping communication with this node.");
+            recordCommPeriod();
             return false;
         }
-        Log::info("Sensor data received from ", n.getMACAddress().toString(), " with length ", sensorData->getLength());
-        data.push_back(*sensorData);
+        n.getLinkStats().recordFrame(lora.getLastLinkMetrics());
+        Log::info("Sensor data received from ", n.getMACAddress(), " with length ", sensorData->getLength());
+        if (n.acceptSequence(sensorData->getSequence()))
+        {
+            n.fillDeadBandGaps(*sensorData, lora.getMACAddress(), data);
+            data.push_back(*sensorData);
+        }
+        else
+            Log::info("Dropped duplicate sensor data with sequence number ", sensorData->getSequence(), " from ", n.getMACAddress());
         messagesReceived++;
         if (sensorData->isLast() || messagesReceived >= n.getMaxMessages())
         {
             Log::debug("Last message received.");
             break;
         }
-        Log::debug("Sending data ACK to ", n.getMACAddress().toString(), " ...");
+        Log::debug("Sending data ACK to ", n.getMACAddress(), " ...");
         lora.sendMessage(Message<ACK_DATA>(lora.getMACAddress(), n.getMACAddress()));
     }
     uint32_t commTime{n.getNextCommTime() + commInterval};
     if (lambdaIsLost(n) && !(std::all_of(nodes.cbegin(), nodes.cend(), lambdaIsLost)))
         commTime = nextScheduledCommTime();
-    Log::info("Sending time config message to ", n.getMACAddress().toString(), " ...");
+    Log::info("Sending time config message to ", n.getMACAddress(), " ...");
     cTime = rtc.getSysTime();
     Message<TIME_CONFIG> timeConfig{lora.getMACAddress(),
                                     n.getMACAddress(),
@@ -255,35 +629,112 @@ bool Gateway::nodeCommPeriod(Node& n, std::vector<Message<SENSOR_DATA>>& data)
                                     n.getSampleOffset(),
                                     commInterval,
                                     commTime,
-                                    MAX_MESSAGES(commInterval, n.getSampleInterval())};
+                                    MAX_MESSAGES(commInterval, n.getShortestSampleInterval())};
     lora.sendMessage(timeConfig);
     auto timeAck = lora.receiveMessage<ACK_TIME>(TIME_CONFIG_TIMEOUT, TIME_CONFIG_ATTEMPTS, n.getMACAddress());
     if (!timeAck)
     {
-        Log::error("Error while receiving ack to time config message from ", n.getMACAddress().toString(), ". Skipping communication with this node.");
+        Log::error("Error while receiving ack to time config message from ", n.getMACAddress(), ". Skipping communication with this node.");
+        recordCommPeriod();
         return false;
     }
-    Log::info("Communication with node ", n.getMACAddress().toString(), " successful: ", messagesReceived, " messages received");
+    n.getLinkStats().recordFrame(lora.getLastLinkMetrics());
+    recordCommPeriod();
+    Log::info("Communication with node ", n.getMACAddress(), " successful: ", messagesReceived, " messages received");
     n.timeConfig(timeConfig);
+    sendSensorConfig(n);
+    return true;
+}
+
+void Gateway::sendSensorConfig(Node& n)
+{
+    if (!n.areSchedulesPending())
+        return;
+    Log::info("Sending sensor config message with ", n.getNSchedules(), " schedules to ", n.getMACAddress(), " ...");
+    lora.sendMessage(Message<SENSOR_CONFIG>(lora.getMACAddress(), n.getMACAddress(), n.getSchedules(), n.getNSchedules()));
+    if (!lora.receiveMessage<ACK_SENSOR_CONFIG>(TIME_CONFIG_TIMEOUT, TIME_CONFIG_ATTEMPTS, n.getMACAddress()))
+    {
+        Log::error("Error while receiving ack to sensor config message from ", n.getMACAddress(), ". Retrying during the next comm period.");
+        return;
+    }
+    n.schedulesAcknowledged();
+}
+
+bool Gateway::wifiAwaitConnection(uint32_t timeoutMs)
+{
+    int64_t timeout{esp_timer_get_time() + static_cast<int64_t>(timeoutMs) * 1000};
+    while (WiFi.status() != WL_CONNECTED)
+    {
+        if (esp_timer_get_time() >= timeout)
+            return false;
+        delay(10);
+    }
     return true;
 }
 
+/// @return The renewal time (T1) in seconds of the DHCP lease of the WiFi station, as granted by the server. Half the lease time if the server did not
+/// send one, 0 if there is no lease.
+static uint32_t dhcpRenewalTime()
+{
+    esp_netif_t* netif{esp_netif_get_handle_from_ifkey("WIFI_STA_DEF")};
+    struct netif* lwipNetif{netif ? static_cast<struct netif*>(esp_netif_get_netif_impl(netif)) : nullptr};
+    struct dhcp* dhcp{lwipNetif ? netif_dhcp_data(lwipNetif) : nullptr};
+    if (!dhcp)
+        return 0;
+    return dhcp->offered_t1_renew > 0 ? dhcp->offered_t1_renew : dhcp->offered_t0_lease / 2;
+}
+
 void Gateway::wifiConnect(const char* SSID, const char* password)
 {
     Log::info("Connecting to WiFi with SSID: ", SSID);
-    WiFi.begin(SSID, password);
-    for (size_t i = 10; i > 0 && WiFi.status() != WL_CONNECTED; i--)
+    WiFi.persistent(false); // credentials are kept in RTC memory, avoid flash writes on every connect
+    int64_t start{esp_timer_get_time()};
+    // past the renewal time the server may hand the address to another device, so the lease is renewed through DHCP
+    bool fastPath{wifiCache.valid && strncmp(SSID, ssid, sizeof(ssid)) == 0 && rtc.getSysTime() - wifiCache.leaseTime < wifiCache.renewalTime};
+    bool connected{false};
+    if (fastPath)
     {
-        delay(1000);
-        Serial.print('.');
+        Log::debug("Attempting fast reconnect on channel ", wifiCache.channel, ".");
+        WiFi.config(IPAddress(wifiCache.ip), IPAddress(wifiCache.gateway), IPAddress(wifiCache.subnet), IPAddress(wifiCache.dns));
+        WiFi.begin(SSID, password, wifiCache.channel, wifiCache.bssid);
+        connected = wifiAwaitConnection(WIFI_FAST_TIMEOUT);
+        if (!connected)
+        {
+            Log::info("Fast WiFi reconnect failed, falling back to full connect.");
+            wifiStats.fastFailures++;
+            fastPath = false;
+            WiFi.disconnect();
+            WiFi.config(INADDR_NONE, INADDR_NONE, INADDR_NONE); // re-enable DHCP
+        }
     }
-    Serial.print('\n');
-    if (WiFi.status() != WL_CONNECTED)
+    if (!connected)
+    {
+        WiFi.begin(SSID, password);
+        connected = wifiAwaitConnection(WIFI_TIMEOUT);
+    }
+    if (!connected)
     {
         Log::error("Could not connect to WiFi.");
+        wifiStats.failures++;
+        wifiCache.valid = false;
         return;
     }
-    Log::info("Connected to WiFi.");
+    uint32_t latency{static_cast<uint32_t>((esp_timer_get_time() - start) / 1000)};
+    wifiStats.record(latency, fastPath);
+    Log::info("Connected to WiFi in ", latency, " ms", fastPath ? " (fast reconnect)." : ".");
+    if (!fastPath)
+    {
+        memcpy(wifiCache.bssid, WiFi.BSSID(), sizeof(wifiCache.bssid));
+        wifiCache.channel = WiFi.channel();
+        wifiCache.ip = WiFi.localIP();
+        wifiCache.gateway = WiFi.gatewayIP();
+        wifiCache.subnet = WiFi.subnetMask();
+        wifiCache.dns = WiFi.dnsIP();
+        wifiCache.leaseTime = rtc.getSysTime();
+        wifiCache.renewalTime = std::min<uint32_t>(dhcpRenewalTime(), WIFI_CACHE_LIFETIME);
+        wifiCache.valid = true;
+        Log::debug("DHCP lease is reused until ", wifiCache.renewalTime, " s from now.");
+    }
     strncpy(ssid, SSID, sizeof(ssid));
     strncpy(pass, password, sizeof(pass));
 }
@@ -292,7 +743,6 @@ void Gateway::wifiConnect() { wifiConnect(ssid, pass); }
 
 bool Gateway::mqttConnect()
 {
-    mqtt.setBufferSize(512);
     char* clientID{lora.getMACAddress().toString()};
     for (size_t i = 0; i < MQTT_ATTEMPTS; i++)
     {
@@ -312,65 +762,240 @@ char* Gateway::createTopic(char* topic, const MACAddress& nodeMAC)
     return topic;
 }
 
-void Gateway::uploadPeriod()
+uint16_t Gateway::publishBatch(UploadBatch& batch)
 {
-    Log::info("Commencing upload to MQTT server...");
-    wifiConnect();
-    if (WiFi.status() != WL_CONNECTED)
+    char topic[topicSize];
+    createTopic(topic, batch.getNode());
+    uint16_t packetId{mqtt.publish(topic, batch.getPayload(), batch.getPayloadLength())};
+    if (packetId != 0)
+        Log::debug("MQTT batch of ", batch.getNRecords(), " messages sent with packet id ", packetId, ".");
+    else
+        Log::error("Error while publishing to MQTT server.");
+    return packetId;
+}
+
+bool Gateway::readRecord(const RecordRef& ref, uint8_t* buffer)
+{
+    std::lock_guard<std::mutex> lock{dataFileMutex};
+    Trace::record(TRACE_FLASH_BEGIN, ref.size);
+    File data{LittleFS.open(DATA_FP, "r")};
+    bool read{data.seek(ref.flagPosition) && data.read(buffer, ref.size) == ref.size};
+    data.close();
+    Trace::record(TRACE_FLASH_END);
+    return read;
+}
+
+void Gateway::markUploaded(const std::vector<size_t>& flagPositions)
+{
+    std::lock_guard<std::mutex> lock{dataFileMutex};
+    Trace::record(TRACE_FLASH_BEGIN, flagPositions.size());
+    File data{LittleFS.open(DATA_FP, "r+")};
+    for (size_t flagPosition : flagPositions)
     {
-        Log::error("WiFi not connected. Aborting upload to MQTT server...");
-        return;
+        data.seek(flagPosition);
+        data.write(1);
+    }
+    data.close();
+    Trace::record(TRACE_FLASH_END);
+}
+
+void Gateway::scanPending()
+{
+    uploadPolicy.pendingBytes = 0;
+    uploadPolicy.oldestPending = 0;
+    std::lock_guard<std::mutex> lock{dataFileMutex};
+    File data{LittleFS.open(DATA_FP, "r")};
+    std::array<uint8_t, UINT8_MAX> buffer;
+    while (data.available())
+    {
+        uint8_t size = data.read();
+        if (data.read(buffer.data(), size) != size)
+            break;
+        if (buffer[0] != 0) // upload flag: already uploaded
+            continue;
+        uploadPolicy.recordStored(1 + size, Message<SENSOR_DATA>::fromData(buffer.data()).getCTime());
+    }
+    data.close();
+}
+
+uint32_t Gateway::queuePending(uint32_t from)
+{
+    std::lock_guard<std::mutex> lock{dataFileMutex};
+    File data{LittleFS.open(DATA_FP, "r")};
+    uint32_t deferredFrom{NO_DEFERRED_RECORDS};
+    if (!data.seek(from))
+    {
+        data.close();
+        return deferredFrom;
     }
-    size_t nErrors{0}; // amount of errors while uploading
-    size_t messagesPublished{0};
-    bool upload{true};
-    File data{LittleFS.open(DATA_FP, "r+")};
     while (data.available())
     {
+        uint32_t position = data.position();
         uint8_t size = data.read();
-        uint8_t buffer[size];
-        data.read(buffer, size);
-        if (buffer[0] == 0 && upload) // upload flag: not yet uploaded
+        uint32_t flagPosition = data.position();
+        int flag = data.read();
+        if (flag < 0 || !data.seek(flagPosition + size))
+            break;
+        if (flag != 0) // already uploaded
+            continue;
+        if (!uplinkQueue.push(RecordRef{flagPosition, size}))
         {
-            auto& message{Message<SENSOR_DATA>::fromData(buffer)};
-            char topic[topicSize];
-            createTopic(topic, message.getSource());
+            deferredFrom = position;
+            break;
+        }
+    }
+    data.close();
+    return deferredFrom;
+}
 
-            if (mqtt.connected() || mqttConnect())
-            {
-                if (mqtt.publish(topic, &buffer[message.headerLength], message.getLength() - message.headerLength))
-                {
-                    Log::debug("MQTT message succesfully published.");
-                    // mark uploaded
-                    size_t curPos{data.position()};
-                    data.seek(curPos - size);
-                    data.write(1);
-                    data.seek(curPos);
-                    messagesPublished++;
-                }
-                else
-                {
-                    Log::error("Error while publishing to MQTT server. State: ", mqtt.state());
-                    nErrors++;
-                }
-            }
-            else
-            {
-                Log::error("Error while connecting to MQTT server. Aborting upload. State: ", mqtt.state());
-                upload = false;
-            }
+void Gateway::startUplink()
+{
+    uplinkProducerDone = false;
+    uplinkResult = UplinkResult{};
+    scanPending();
+    uplinkDeferredFrom = queuePending(0);
+    if (uplinkDone == nullptr)
+        uplinkDone = xSemaphoreCreateBinary();
+    lora.setLightSleep(false);
+    uplinkRunning = true;
+    if (xTaskCreatePinnedToCore(uplinkTask, "uplink", UPLINK_TASK_STACK, this, UPLINK_TASK_PRIORITY, nullptr, UPLINK_CORE) != pdPASS)
+    {
+        Log::error("Could not create uplink task. Upload is deferred.");
+        uplinkRunning = false;
+        lora.setLightSleep(true);
+        RecordRef ref;
+        while (uplinkQueue.pop(ref))
+            ;
+        uplinkDeferredFrom = NO_DEFERRED_RECORDS;
+    }
+}
+
+void Gateway::finishUplink()
+{
+    if (!uplinkRunning)
+        return;
+    // refill the queue as the uplink task drains it, until every pending record has been queued
+    while (uplinkDeferredFrom != NO_DEFERRED_RECORDS)
+    {
+        while (!uplinkQueue.empty())
+            vTaskDelay(pdMS_TO_TICKS(UPLINK_POLL_INTERVAL));
+        uplinkDeferredFrom = queuePending(uplinkDeferredFrom);
+    }
+    uplinkProducerDone = true;
+    xSemaphoreTake(uplinkDone, portMAX_DELAY);
+    uplinkRunning = false;
+    lora.setLightSleep(true);
+    uploadPolicy.uploadFinished(uplinkResult.succeeded, rtc.getSysTime());
+    uploadPolicy.pendingBytes -= std::min(uploadPolicy.pendingBytes, uplinkResult.bytes);
+    if (uploadPolicy.pendingBytes == 0)
+        uploadPolicy.oldestPending = 0;
+    uploadStats.attempts++;
+    if (!uplinkResult.succeeded)
+        uploadStats.failures++;
+    uploadStats.records += uplinkResult.records;
+    uploadStats.bytes += uplinkResult.bytes;
+    uploadStats.connectMs += uplinkResult.connectMs;
+    uploadStats.activeMs += uplinkResult.activeMs;
+    if (!uplinkResult.succeeded)
+        Log::info("Upload failed ", uploadPolicy.consecutiveFailures, " times in a row, backing off until ", uploadPolicy.backoffUntil, ".");
+    std::lock_guard<std::mutex> lock{dataFileMutex};
+    pruneSensorData(LittleFS.open(DATA_FP, "r"), MAX_SENSORDATA_FILESIZE);
+}
+
+void Gateway::uplinkTask(void* gateway)
+{
+    Gateway* self{static_cast<Gateway*>(gateway)};
+    self->uploadPeriod();
+    xSemaphoreGive(self->uplinkDone);
+    vTaskDelete(nullptr);
+}
+
+void Gateway::uploadPeriod()
+{
+    Log::info("Commencing upload to MQTT server on core ", xPortGetCoreID(), "...");
+    int64_t start{esp_timer_get_time()};
+    wifiConnect();
+    bool upload{WiFi.status() == WL_CONNECTED && mqttConnect()};
+    uplinkResult.connectMs = (esp_timer_get_time() - start) / 1000;
+    if (!upload)
+        Log::error("Could not connect to WiFi or MQTT server. Aborting upload to MQTT server...");
+    size_t nErrors{0}; // amount of errors while uploading
+    std::vector<UploadBatch> batches;
+    // flag positions and stored size of the batches that have been published but not yet acknowledged, by packet identifier
+    std::vector<std::tuple<uint16_t, std::vector<size_t>, size_t>> unacknowledged;
+    mqtt.setAckCallback(
+        [&](uint16_t packetId)
+        {
+            auto batch{std::find_if(unacknowledged.begin(), unacknowledged.end(), [&](const auto& b) { return std::get<0>(b) == packetId; })};
+            if (batch == unacknowledged.end())
+                return;
+            markUploaded(std::get<1>(*batch));
+            uplinkResult.records += std::get<1>(*batch).size();
+            uplinkResult.bytes += std::get<2>(*batch);
+            unacknowledged.erase(batch);
+        });
+    auto lambdaPublish = [&](UploadBatch& batch)
+    {
+        if (!(mqtt.connected() || mqttConnect()))
+        {
+            Log::error("Error while connecting to MQTT server. Aborting upload.");
+            upload = false;
+            return;
         }
+        uint16_t packetId{publishBatch(batch)};
+        if (packetId != 0)
+            unacknowledged.emplace_back(packetId, batch.getFlagPositions(), batch.getStoredBytes());
+        else
+            nErrors++;
+        batch.clear();
         if (nErrors >= MAX_MQTT_ERRORS)
         {
             Log::error("Too many errors while publishing to MQTT server. Aborting upload.");
             upload = false;
         }
+    };
+    auto lambdaPublishAll = [&]()
+    {
+        for (UploadBatch& batch : batches)
+        {
+            if (upload && !batch.isEmpty())
+                lambdaPublish(batch);
+        }
+    };
+    RecordRef ref;
+    std::array<uint8_t, UINT8_MAX> buffer; // a record's size is stored in a single byte
+    // once aborted, the queue is still drained so the main task never blocks on it; the records are left for the next upload
+    while (!(uplinkProducerDone && uplinkQueue.empty()))
+    {
+        if (!uplinkQueue.pop(ref))
+        {
+            // the main task is busy with a node, publish what has been gathered so far instead of idling
+            lambdaPublishAll();
+            if (upload)
+                mqtt.loop();
+            vTaskDelay(pdMS_TO_TICKS(UPLINK_POLL_INTERVAL));
+            continue;
+        }
+        if (!upload || !readRecord(ref, buffer.data()) || buffer[0] != 0)
+            continue;
+        // the 'upload' flag takes the place of the message type
+        auto& message{Message<SENSOR_DATA>::fromData(buffer.data())};
+        auto batch{std::find_if(batches.begin(), batches.end(), [&](const UploadBatch& b) { return b.getNode() == message.getSource(); })};
+        if (batch == batches.end())
+            batch = batches.emplace(batches.end(), message.getSource(), batchSize);
+        size_t recordLength{message.getLength() - message.headerLength};
+        if (!batch->fits(recordLength))
+            lambdaPublish(*batch);
+        batch->add(&buffer[message.headerLength], recordLength, ref.flagPosition, 1 + ref.size);
     }
+    lambdaPublishAll();
+    if (upload && !mqtt.flush(MQTT_ACK_TIMEOUT))
+        Log::error(unacknowledged.size(), " MQTT batches were not acknowledged in time and will be retried during the next upload.");
     mqtt.disconnect();
-    Log::info("MQTT upload finished with ", messagesPublished, " messages sent.");
-    commPeriods = 0;
-    data.seek(0);
-    pruneSensorData(std::move(data), MAX_SENSORDATA_FILESIZE);
+    mqtt.setAckCallback(nullptr);
+    uplinkResult.succeeded = upload;
+    uplinkResult.activeMs = (esp_timer_get_time() - start) / 1000;
+    Log::info("MQTT upload finished with ", uplinkResult.records, " messages acknowledged in ", uplinkResult.activeMs, " ms.");
 }
 
 void Gateway::parseNodeUpdate(char* update)
@@ -484,6 +1109,111 @@ CommandCode Gateway::Commands::discoveryLoop(char* arg)
     return COMMAND_SUCCESS;
 }
 
+CommandCode Gateway::Commands::printWiFiStats()
+{
+    Serial.println("LATENCY (ms)\tFAST\tFULL");
+    for (size_t i{0}; i < WiFiConnectStats::bounds.size(); i++)
+        Serial.printf("<= %u\t%u\t%u\n", WiFiConnectStats::bounds[i], wifiStats.fast[i], wifiStats.full[i]);
+    Serial.printf("> %u\t%u\t%u\n", WiFiConnectStats::bounds.back(), wifiStats.fast.back(), wifiStats.full.back());
+    Serial.printf("Fast reconnect fallbacks: %u, failed connects: %u, last latency: %u ms\n", wifiStats.fastFailures, wifiStats.failures,
+                  wifiStats.lastLatency);
+    return COMMAND_SUCCESS;
+}
+
+CommandCode Gateway::Commands::printUploadStats()
+{
+    uint32_t cTime{parent->rtc.getSysTime()};
+    Serial.printf("Pending: %u bytes, oldest record %u s old\n", uploadPolicy.pendingBytes,
+                  uploadPolicy.pendingBytes > 0 ? cTime - uploadPolicy.oldestPending : 0);
+    if (uploadPolicy.backoffUntil > cTime)
+        Serial.printf("Backing off for %u s after %u failed uploads\n", uploadPolicy.backoffUntil - cTime, uploadPolicy.consecutiveFailures);
+    Serial.printf("Uploads: %u (%u failed), delivered %u records (%u bytes)\n", uploadStats.attempts, uploadStats.failures, uploadStats.records,
+                  uploadStats.bytes);
+    if (uploadStats.attempts > 0)
+        Serial.printf("Average connect time: %u ms, average active time: %u ms\n", uploadStats.connectMs / uploadStats.attempts,
+                      uploadStats.activeMs / uploadStats.attempts);
+    if (uploadStats.records > 0)
+        Serial.printf("Cost per delivered record: %.1f ms active\n", static_cast<float>(uploadStats.activeMs) / uploadStats.records);
+    return COMMAND_SUCCESS;
+}
+
+CommandCode Gateway::Commands::printLinkStats()
+{
+    Serial.println("MAC\tRSSI (dBm)\tSNR (dB)\tFREQ ERR (Hz)\tLOSS\tFRAMES\tLOST\tREPEATS\tRETRANSMISSIONS");
+    for (const Node& n : parent->nodes)
+    {
+        const LinkStats& stats{n.getLinkStats()};
+        Serial.printf("%s\t%.1f\t%.1f\t%.0f\t%.2f\t%u\t%u\t%u\t%u\n", n.getMACAddress().toString(), stats.rssi, stats.snr, stats.frequencyError,
+                      stats.lossRate, stats.frames, stats.lost, stats.repeats, stats.retransmissions);
+    }
+    return COMMAND_SUCCESS;
+}
+
+CommandCode Gateway::Commands::sensorSchedule(char* mac, char* tag, char* interval, char* offset)
+{
+    auto n{parent->macToNode(mac)};
+    if (!n)
+        return COMMAND_ERROR;
+    if (!n->get().setSchedule(strtoul(tag, nullptr, 10), strtoul(interval, nullptr, 10), strtoul(offset, nullptr, 10)))
+    {
+        Serial.printf("Max count of sensor schedules (%u) reached for this node.\n", MAX_SENSOR_SCHEDULES);
+        return COMMAND_ERROR;
+    }
+    parent->updateNodesFile();
+    Serial.println("Sensor schedule will be sent during the node's next comm period.");
+    return COMMAND_SUCCESS;
+}
+
+CommandCode Gateway::Commands::sensorAggregate(char* mac, char* tag, char* readInterval)
+{
+    auto n{parent->macToNode(mac)};
+    if (!n)
+        return COMMAND_ERROR;
+    uint16_t sensorTag{static_cast<uint16_t>(strtoul(tag, nullptr, 10))};
+    uint32_t sensorReadInterval{strtoul(readInterval, nullptr, 10)};
+    uint32_t interval{n->get().getSampleInterval()};
+    for (size_t i{0}; i < n->get().getNSchedules(); i++)
+    {
+        if (n->get().getSchedules()[i].appliesTo(sensorTag >> 4))
+            interval = n->get().getSchedules()[i].interval;
+    }
+    if (sensorReadInterval >= interval)
+    {
+        Serial.printf("The read interval must be shorter than the sensor's sample interval (%u s).\n", interval);
+        return COMMAND_ERROR;
+    }
+    if (!n->get().setReadInterval(sensorTag, sensorReadInterval))
+    {
+        Serial.printf("Max count of sensor schedules (%u) reached for this node.\n", MAX_SENSOR_SCHEDULES);
+        return COMMAND_ERROR;
+    }
+    parent->updateNodesFile();
+    Serial.println("Sensor schedule will be sent during the node's next comm period.");
+    return COMMAND_SUCCESS;
+}
+
+CommandCode Gateway::Commands::sensorDeadBand(char* mac, char* tag, char* deadBand, char* maxSilence)
+{
+    auto n{parent->macToNode(mac)};
+    if (!n)
+        return COMMAND_ERROR;
+    float sensorDeadBand{strtof(deadBand, nullptr)};
+    uint32_t sensorMaxSilence{strtoul(maxSilence, nullptr, 10)};
+    if (sensorDeadBand < 0 || (sensorDeadBand > 0 && sensorMaxSilence == 0))
+    {
+        Serial.println("The dead-band must be positive and needs a max silence, so that the gateway can tell values left out from values lost.");
+        return COMMAND_ERROR;
+    }
+    if (!n->get().setDeadBand(strtoul(tag, nullptr, 10), sensorDeadBand, sensorMaxSilence))
+    {
+        Serial.printf("Max count of sensor schedules (%u) reached for this node.\n", MAX_SENSOR_SCHEDULES);
+        return COMMAND_ERROR;
+    }
+    parent->updateNodesFile();
+    Serial.println("Sensor schedule will be sent during the node's next comm period.");
+    return COMMAND_SUCCESS;
+}
+
 CommandCode Gateway::Commands::printSchedule()
 {
     constexpr size_t timeLength{sizeof("0000-00-00 00:00:00")};
@@ -496,6 +1226,12 @@ CommandCode Gateway::Commands::printSchedule()
         gmtime_r(&nextNodeCommTime, &time);
         strftime(buffer, timeLength, "%F %T", &time);
         Serial.printf("%s\t%s\t%u\t%u\n", n.getMACAddress().toString(), buffer, n.getSampleInterval(), n.getMaxMessages());
+        for (size_t i{0}; i < n.getNSchedules(); i++)
+        {
+            const SensorSchedule& schedule{n.getSchedules()[i]};
+            Serial.printf("\tTag %u: sample interval %u, offset %u, read interval %u, dead-band %g, max silence %u%s\n", schedule.tag, schedule.interval,
+                          schedule.offset, schedule.readInterval, schedule.deadBand, schedule.maxSilence, n.areSchedulesPending() ? " (pending)" : "");
+        }
     }
     return COMMAND_SUCCESS;
 }
\ No newline at end of file
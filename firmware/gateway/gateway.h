@@ -3,15 +3,55 @@
 
 #include "Commands.h"
 #include "MIRRAModule.h"
-#include "PubSubClient.h"
+#include "MQTTUplink.h"
+#include "ReportedValues.h"
+#include "SPSCQueue.h"
+#include "SensorDataBatch.h"
 #include "WiFi.h"
 #include "config.h"
+#include <atomic>
+#include <mutex>
 #include <vector>
 
 #define COMM_PERIOD_LENGTH(MAX_MESSAGES) ((MAX_MESSAGES * SENSOR_DATA_TIMEOUT + TIME_CONFIG_TIMEOUT) / 1000)
 #define IDEAL_MESSAGES(COMM_INTERVAL, SAMP_INTERVAL) (COMM_INTERVAL / SAMP_INTERVAL)
 #define MAX_MESSAGES(COMM_INTERVAL, SAMP_INTERVAL) ((3 * COMM_INTERVAL / (2 * SAMP_INTERVAL)) + 1)
 
+#define LINK_STATS_TYPE 0xF10 // reserved sensor type ID of the link statistics telemetry of a node, see LinkStats
+
+/// @brief Rolling link quality statistics of a node as seen by the gateway. The averages are exponentially weighted moving averages, the counters are reset
+/// whenever the statistics are uploaded.
+struct LinkStats
+{
+    /// @brief Weight of a new sample in the moving averages.
+    static constexpr float weight{0.25};
+    float rssi{0};
+    float snr{0};
+    float frequencyError{0};
+    /// @brief Moving average of the fraction of frames lost per comm period.
+    float lossRate{0};
+    /// @brief Frames received from the node.
+    uint32_t frames{0};
+    /// @brief Frames from the node that were expected but not received in time or corrupted.
+    uint32_t lost{0};
+    /// @brief REPEAT messages sent to the node.
+    uint32_t repeats{0};
+    /// @brief Messages resent to the node on its request.
+    uint32_t retransmissions{0};
+
+    /// @brief Records the link quality of a frame received from the node.
+    void recordFrame(const LinkMetrics& metrics);
+    /// @brief Records the radio events of a comm period with the node.
+    /// @param start Radio event counters at the start of the comm period.
+    /// @param end Radio event counters at the end of the comm period.
+    void recordCommPeriod(const LinkCounters& start, const LinkCounters& end);
+    /// @brief Writes the statistics as sensor values tagged with type LINK_STATS_TYPE and instances 0 (RSSI, dBm), 1 (SNR, dB), 2 (frequency error, Hz),
+    /// 3 (loss rate), 4 (frames), 5 (lost frames), 6 (repeats) and 7 (retransmissions), and resets the counters.
+    /// @param values Array of at least 8 values to write to.
+    /// @return The amount of values written.
+    size_t emit(SensorValue* values);
+};
+
 /// @brief Representation of a Sensor Node's attributes relevant for communication, used for tracking the status of nodes from the gateway.
 class Node
 {
@@ -25,6 +65,22 @@ private:
     uint32_t nextCommTime{0};
     uint32_t maxMessages{0};
     uint32_t errors{0};
+    /// @brief Highest record sequence number received from this node.
+    uint16_t lastSequence{0};
+    /// @brief Bitmap of recently received sequence numbers, where bit i is set if (lastSequence - i) has been received. Empty if nothing was received yet.
+    uint32_t sequenceWindow{0};
+    LinkStats linkStats{};
+    /// @brief Per-sensor sampling schedules of this node, overriding its sample interval for the sensors with a matching tag.
+    std::array<SensorSchedule, MAX_SENSOR_SCHEDULES> schedules{};
+    static_assert(MAX_SENSOR_SCHEDULES <= Message<SENSOR_CONFIG>::maxNSchedules, "MAX_SENSOR_SCHEDULES does not fit a single sensor config message.");
+    uint8_t nSchedules{0};
+    /// @brief Whether the schedules have changed since the node last acknowledged them.
+    bool schedulesPending{false};
+    /// @brief Last value received of each tag of the node's dead-banded sensors.
+    ReportedValues<DEAD_BAND_MAX_VALUES> reportedValues{};
+    /// @brief Marks the schedules to be sent to the node, and forgets the values received of the sensor whose schedule changed.
+    /// @param tag Tag of the sensor's values.
+    void scheduleChanged(uint16_t tag);
 
 public:
     Node() {}
@@ -34,6 +90,48 @@ public:
     void timeConfig(Message<TIME_CONFIG>& m);
     /// @brief Configures the Node as if the time config message was missed, the same way the actual module would do.
     void naiveTimeConfig(uint32_t cTime);
+    /// @brief Registers a received record sequence number in the node's seen-window.
+    /// @param sequence The sequence number of the received sensor data message.
+    /// @return False if the sequence number was already seen (i.e. the record is a duplicate), else true.
+    bool acceptSequence(uint16_t sequence);
+    /// @brief Size of the seen-window in records. Sequence numbers further behind than this are assumed to stem from a reset node.
+    static constexpr uint16_t sequenceWindowSize{sizeof(sequenceWindow) * 8};
+    /// @return Whether all records with a sequence number between the given ones (exclusive) have been received, false if this is not known because they
+    /// have left the seen-window.
+    bool receivedBetween(uint16_t from, uint16_t to) const;
+    /// @brief Sets, replaces or removes the sampling schedule of the sensor with the given tag, to be sent to the node during its next comm period.
+    /// @param tag Tag of the sensor's values. The instance bits are ignored.
+    /// @param interval Sample interval in seconds, 0 to remove the schedule and revert the sensor to the node's sample interval.
+    /// @param offset Phase offset in seconds.
+    /// @return False if the maximum amount of schedules has been reached, else true.
+    bool setSchedule(uint16_t tag, uint32_t interval, uint32_t offset);
+    /// @brief Sets the read interval of the sensor with the given tag, whose readings are then aggregated over each sample interval. A sensor without a
+    /// schedule is given one with the node's sample interval.
+    /// @param tag Tag of the sensor's values. The instance bits are ignored.
+    /// @param readInterval Read interval in seconds, 0 to store every reading.
+    /// @return False if the maximum amount of schedules has been reached, else true.
+    bool setReadInterval(uint16_t tag, uint32_t readInterval);
+    /// @brief Sets the dead-band of the sensor with the given tag, whose values are then only stored by the node when they change. A sensor without a
+    /// schedule is given one with the node's sample interval.
+    /// @param tag Tag of the sensor's values. The instance bits are ignored.
+    /// @param deadBand Dead-band of the sensor's values, 0 to store every value.
+    /// @param maxSilence Maximum time in seconds between two stored values of each of the sensor's tags.
+    /// @return False if the maximum amount of schedules has been reached, else true.
+    bool setDeadBand(uint16_t tag, float deadBand, uint32_t maxSilence);
+    /// @brief Fills in the values of the node's dead-banded sensors that the node left out before a received record, repeating the last received value of
+    /// each tag at every sample interval since. Gaps are filled up to the sensor's max silence, beyond which values were lost rather than left out. A gap
+    /// is only filled if every record the node stored in between has been received, so that a record arriving late never meets a filled in value for its
+    /// time. The records holding the filled in values have Message<SENSOR_DATA>::filledSequence as sequence number.
+    /// @param m The received record, not yet stored.
+    /// @param gatewayMAC MAC address of this gateway, the destination of the records.
+    /// @param data Records to be stored, to which the records holding the filled in values are appended.
+    void fillDeadBandGaps(Message<SENSOR_DATA>& m, const MACAddress& gatewayMAC, std::vector<Message<SENSOR_DATA>>& data);
+    /// @brief Takes over the schedules of the previous entry of a rediscovered (i.e. reset) node, marking them to be sent again.
+    void inheritSchedules(const Node& previous);
+    /// @brief Marks the schedules as acknowledged by the node.
+    void schedulesAcknowledged() { schedulesPending = false; }
+    /// @return The shortest sample interval of any of the node's sensors.
+    uint32_t getShortestSampleInterval() const;
 
     const MACAddress& getMACAddress() const { return mac; }
     uint32_t getSampleInterval() const { return sampleInterval; }
@@ -43,12 +141,152 @@ public:
     uint32_t getCommInterval() const { return commInterval; }
     uint32_t getNextCommTime() const { return nextCommTime; }
     uint32_t getMaxMessages() const { return maxMessages; }
+    const SensorSchedule* getSchedules() const { return schedules.data(); }
+    size_t getNSchedules() const { return nSchedules; }
+    bool areSchedulesPending() const { return schedulesPending; }
+    LinkStats& getLinkStats() { return linkStats; }
+    const LinkStats& getLinkStats() const { return linkStats; }
 
     void setSampleInterval(uint32_t sampleInterval) { this->sampleInterval = sampleInterval; }
     void setSampleRounding(uint32_t sampleRounding) { this->sampleRounding = sampleRounding; }
     void setSampleOffset(uint32_t sampleOffset) { this->sampleOffset = sampleOffset; }
 };
 
+/// @brief Histogram of WiFi connect latencies, kept separately for fast reconnects and full connects. Retained through deep sleep.
+struct WiFiConnectStats
+{
+    /// @brief Upper bounds (ms) of the histogram buckets. The last bucket holds all latencies above the last bound.
+    static constexpr std::array<uint32_t, 6> bounds{250, 500, 1000, 2000, 4000, 8000};
+    std::array<uint32_t, bounds.size() + 1> fast{0};
+    std::array<uint32_t, bounds.size() + 1> full{0};
+    /// @brief Amount of fast reconnects that fell back to a full connect.
+    uint32_t fastFailures{0};
+    /// @brief Amount of full connects that failed.
+    uint32_t failures{0};
+    /// @brief Latency of the last successful connect in ms.
+    uint32_t lastLatency{0};
+    /// @brief Exponentially weighted moving average of the latency of successful connects in ms, 0 if none succeeded yet.
+    uint32_t averageLatency{0};
+
+    /// @brief Records the latency of a successful connect.
+    /// @param latency Latency in ms.
+    /// @param fastPath Whether the connection was established with a fast reconnect.
+    void record(uint32_t latency, bool fastPath);
+};
+
+/// @brief Connection parameters of the last successful WiFi connection, used for fast reconnects. Retained through deep sleep.
+struct WiFiCache
+{
+    bool valid{false};
+    uint8_t bssid[6]{0};
+    int32_t channel{0};
+    uint32_t ip{0}, gateway{0}, subnet{0}, dns{0};
+    /// @brief Time at which the IP lease was obtained (UNIX epoch, seconds).
+    uint32_t leaseTime{0};
+    /// @brief Time in seconds after leaseTime up to which the lease is reused: the renewal time (T1) granted by the DHCP server, at most
+    /// WIFI_CACHE_LIFETIME. 0 if unknown, in which case the lease is not reused.
+    uint32_t renewalTime{0};
+};
+
+/// @brief Decides per wake whether an upload is worthwhile, weighing the backlog of stored records against the expected WiFi connect cost, and backs off
+/// exponentially while uploads fail. Retained through deep sleep.
+struct UploadPolicy
+{
+    /// @brief Bytes of stored records not yet uploaded.
+    uint32_t pendingBytes{0};
+    /// @brief Sample time of the oldest record not yet uploaded (UNIX epoch, seconds), 0 if there is none.
+    uint32_t oldestPending{0};
+    /// @brief Amount of uploads that failed in a row.
+    uint32_t consecutiveFailures{0};
+    /// @brief Time before which no upload is attempted (UNIX epoch, seconds).
+    uint32_t backoffUntil{0};
+
+    /// @brief Accounts for a newly stored record.
+    /// @param bytes Size of the record in the data file.
+    /// @param sampleTime Sample time of the record.
+    void recordStored(uint32_t bytes, uint32_t sampleTime);
+    /// @brief Decides whether to upload. An upload is started if the oldest record exceeds UPLOAD_MAX_DELAY, if the backlog exceeds UPLOAD_MAX_BACKLOG,
+    /// or if the backlog is large enough to amortise the expected connect time (UPLOAD_BYTES_PER_CONNECT_MS), unless backing off after failures.
+    /// @param cTime The current time (UNIX epoch, seconds).
+    /// @param expectedConnectMs Expected time to connect to WiFi in ms, 0 if unknown.
+    bool shouldUpload(uint32_t cTime, uint32_t expectedConnectMs) const;
+    /// @brief Updates the backoff after an upload.
+    /// @param success Whether the server could be reached.
+    /// @param cTime The current time (UNIX epoch, seconds).
+    void uploadFinished(bool success, uint32_t cTime);
+};
+
+/// @brief Cumulative cost of uploads, used to evaluate the upload policy. Retained through deep sleep.
+struct UploadStats
+{
+    uint32_t attempts{0};
+    uint32_t failures{0};
+    uint32_t records{0};
+    uint32_t bytes{0};
+    /// @brief Total time spent connecting to WiFi and the MQTT server in ms.
+    uint32_t connectMs{0};
+    /// @brief Total time the uplink was active (i.e. WiFi powered) in ms.
+    uint32_t activeMs{0};
+};
+
+/// @brief Outcome of a single upload, reported by the uplink task.
+struct UplinkResult
+{
+    /// @brief Whether the server could be reached and the upload was not aborted.
+    bool succeeded{false};
+    uint32_t records{0};
+    uint32_t bytes{0};
+    uint32_t connectMs{0};
+    uint32_t activeMs{0};
+};
+
+/// @brief Accumulates the stored sensor data records of a single node into one batched MQTT payload, encoded by SensorDataBatch.
+class UploadBatch
+{
+private:
+    /// @brief Source node of the batched records.
+    MACAddress node;
+    /// @brief The batched payload, see SensorDataBatch.
+    std::vector<uint8_t> payload;
+    /// @brief Positions of the 'upload' flags in the data file of each batched record.
+    std::vector<size_t> flagPositions;
+    /// @brief Size of the batched records in the data file in bytes.
+    size_t storedBytes{0};
+    /// @brief Maximum size of the payload in bytes.
+    size_t capacity;
+
+public:
+    UploadBatch(const MACAddress& node, size_t capacity) : node{node}, capacity{capacity} { SensorDataBatch::begin(payload); }
+
+    const MACAddress& getNode() const { return node; }
+    const uint8_t* getPayload() const { return payload.data(); }
+    size_t getPayloadLength() const { return payload.size(); }
+    const std::vector<size_t>& getFlagPositions() const { return flagPositions; }
+    size_t getStoredBytes() const { return storedBytes; }
+    size_t getNRecords() const { return SensorDataBatch::getNRecords(payload); }
+    bool isEmpty() const { return getNRecords() == 0; }
+
+    /// @return Whether a record of the given length can still be added to this batch.
+    bool fits(size_t recordLength) const { return getNRecords() < UINT8_MAX && payload.size() + 1 + recordLength <= capacity; }
+    /// @brief Appends a record to this batch.
+    /// @param record Pointer to the record.
+    /// @param length Length of the record in bytes.
+    /// @param flagPosition Position of the record's 'upload' flag in the data file.
+    /// @param storedSize Size of the record in the data file in bytes.
+    void add(const uint8_t* record, uint8_t length, size_t flagPosition, size_t storedSize);
+    /// @brief Empties this batch.
+    void clear();
+};
+
+/// @brief Reference to a sensor data record stored in the data file, handed from the comm period to the uplink task.
+struct RecordRef
+{
+    /// @brief Position of the record's 'upload' flag in the data file. The record follows the flag.
+    uint32_t flagPosition;
+    /// @brief Size of the record in bytes, including the 'upload' flag.
+    uint8_t size;
+};
+
 class Gateway : public MIRRAModule
 {
 public:
@@ -72,6 +310,24 @@ public:
         /// @brief Prints scheduling information about the connected nodes, including MAC address, next comm time, sample interval and max number of messages
         /// per comm period.
         CommandCode printSchedule();
+        /// @brief Prints the WiFi connect latency histograms.
+        CommandCode printWiFiStats();
+        /// @brief Prints the upload backlog, backoff and cost statistics.
+        CommandCode printUploadStats();
+        /// @brief Prints the link quality statistics of each node since they were last uploaded.
+        CommandCode printLinkStats();
+        /// @brief Sets the sampling schedule of a single sensor of a node, which is sent to the node during its next comm period.
+        /// @arg The node's MAC address, the sensor's tag, the sample interval in seconds (0 reverts to the node's sample interval) and the phase offset
+        /// in seconds.
+        CommandCode sensorSchedule(char* mac, char* tag, char* interval, char* offset);
+        /// @brief Sets the read interval of a single sensor of a node, which then stores the mean, min, max, standard deviation and count of its readings
+        /// once per sample interval. Sent to the node during its next comm period.
+        /// @arg The node's MAC address, the sensor's tag and the read interval in seconds (0 stores every reading).
+        CommandCode sensorAggregate(char* mac, char* tag, char* readInterval);
+        /// @brief Sets the dead-band of a single sensor of a node, which then only stores a value when it differs more than the dead-band from the last stored
+        /// value, or when the max silence has passed. The gateway fills in the values left out. Sent to the node during its next comm period.
+        /// @arg The node's MAC address, the sensor's tag, the dead-band (0 stores every value) and the max silence in seconds.
+        CommandCode sensorDeadBand(char* mac, char* tag, char* deadBand, char* maxSilence);
 
         static constexpr auto getCommands()
         {
@@ -79,13 +335,35 @@ public:
                                   std::make_tuple(CommandAliasesPair(&Commands::changeWifi, "wifi"), CommandAliasesPair(&Commands::rtcUpdateTime, "rtc"),
                                                   CommandAliasesPair(&Commands::discovery, "discovery"),
                                                   CommandAliasesPair(&Commands::discoveryLoop, "discoveryloop"),
-                                                  CommandAliasesPair(&Commands::printSchedule, "printschedule")));
+                                                  CommandAliasesPair(&Commands::printSchedule, "printschedule"),
+                                                  CommandAliasesPair(&Commands::printWiFiStats, "wifistats"),
+                                                  CommandAliasesPair(&Commands::printUploadStats, "uploadstats"),
+                                                  CommandAliasesPair(&Commands::printLinkStats, "linkstats"),
+                                                  CommandAliasesPair(&Commands::sensorSchedule, "sensorschedule"),
+                                                  CommandAliasesPair(&Commands::sensorAggregate, "sensoraggregate"),
+                                                  CommandAliasesPair(&Commands::sensorDeadBand, "sensordeadband")));
         }
     };
 
 private:
     WiFiClient mqttClient;
-    PubSubClient mqtt;
+    MQTTUplink mqtt;
+
+    /// @brief Records stored during this wake that are still to be uploaded, produced by the main task and consumed by the uplink task.
+    SPSCQueue<RecordRef, UPLINK_QUEUE_SIZE> uplinkQueue;
+    /// @brief Serialises access to the data file between the main task and the uplink task.
+    std::mutex dataFileMutex;
+    /// @brief Whether the uplink task is running.
+    bool uplinkRunning{false};
+    /// @brief Set by the main task once no more records will be queued, after which the uplink task finishes.
+    std::atomic<bool> uplinkProducerDone{false};
+    /// @brief Data file position of the first pending record that did not fit in the uplink queue, NO_DEFERRED_RECORDS if all were queued.
+    uint32_t uplinkDeferredFrom{NO_DEFERRED_RECORDS};
+    static constexpr uint32_t NO_DEFERRED_RECORDS{UINT32_MAX};
+    /// @brief Outcome of the upload, written by the uplink task before it gives uplinkDone.
+    UplinkResult uplinkResult{};
+    /// @brief Given by the uplink task when it has finished.
+    SemaphoreHandle_t uplinkDone{nullptr};
 
     std::vector<Node> nodes;
     /// @brief Returns the local node corresponding to the MAC address.
@@ -96,6 +374,15 @@ private:
     /// @brief Sends a single discovery message, storing the new node and configuring its timings if there is a response.
     void discovery();
 
+    /// @brief Header of the nodes file. The nodes are stored as raw Node objects, so a file written by firmware with another Node layout is discarded.
+    struct __attribute__((packed)) NodesFileHeader
+    {
+        /// @brief Version of the nodes file format, to be incremented whenever the meaning of a Node's fields changes without changing its size.
+        static constexpr uint8_t currentVersion{1};
+        uint8_t version;
+        uint16_t nodeSize;
+        uint8_t nNodes;
+    };
     /// @brief Imports the nodes stored on the local filesystem. Used to retain the Nodes objects through deep sleep.
     void nodesFromFile();
     /// @brief Updates the nodes stored on the local filesystem. Used to retain the Nodes objects through deep sleep.
@@ -111,6 +398,17 @@ private:
     /// @param data Vector to store the data in.
     /// @return Whether the communication period was successful or not.
     bool nodeCommPeriod(Node& n, std::vector<Message<SENSOR_DATA>>& data);
+    /// @brief Sends the node its sensor schedules if they have changed, right after it has acknowledged a time config.
+    /// @param n The node.
+    void sendSensorConfig(Node& n);
+    /// @brief Constructs a sensor data message holding the link statistics of a node, with the node as source, and resets its counters.
+    /// @param n The node.
+    /// @param sequence Sequence number of the message.
+    /// @param time Timestamp of the message (UNIX epoch, seconds).
+    Message<SENSOR_DATA> linkStatsMessage(Node& n, uint16_t sequence, uint32_t time);
+    /// @brief Appends sensor data messages to the data file and, if the uplink task is running, queues them for upload.
+    /// @param data The messages to store. Emptied afterwards.
+    void storeSensorData(std::vector<Message<SENSOR_DATA>>& data);
 
     /// @brief Attempts to connect to the designated MQTT server.
     /// @return Whether the connection was successful or not.
@@ -121,14 +419,50 @@ private:
     /// @param nodeMAC The associated node's MAC address.
     /// @return The topic string.
     char* createTopic(char* topic, const MACAddress& nodeMAC);
-    /// @brief Uploads stored sensor data messages to the MQTT server, and marks uploaded messages as such in the filesystem by setting the 'upload' flag to 1.
+    /// @brief Maximum payload size of a batched publish, leaving room for the MQTT fixed header and topic in the MQTT buffer.
+    const size_t batchSize = MQTT_BUFFER_SIZE - 5 - 2 - topicSize;
+    /// @brief Publishes a batch to the MQTT server at QoS1.
+    /// @param batch The batch to publish.
+    /// @return The packet identifier of the publish, 0 if it could not be sent.
+    uint16_t publishBatch(UploadBatch& batch);
+    /// @brief Reads a stored record from the data file.
+    /// @param ref Reference to the record.
+    /// @param buffer Buffer of at least ref.size bytes to which the record, starting with its 'upload' flag, is written.
+    /// @return Whether the record could be read.
+    bool readRecord(const RecordRef& ref, uint8_t* buffer);
+    /// @brief Marks records as uploaded in the data file by setting their 'upload' flag to 1.
+    /// @param flagPositions Positions of the 'upload' flags of the records to mark.
+    void markUploaded(const std::vector<size_t>& flagPositions);
+    /// @brief Scans the data file for records not yet uploaded, recounting the upload backlog.
+    void scanPending();
+    /// @brief Queues the records not yet uploaded for the uplink task, until the uplink queue is full.
+    /// @param from Data file position of the size byte of the first record to consider.
+    /// @return Data file position of the first pending record that did not fit in the queue, NO_DEFERRED_RECORDS if all were queued.
+    uint32_t queuePending(uint32_t from);
+    /// @brief Queues all records not yet uploaded and starts the uplink task on UPLINK_CORE, so that the upload overlaps with the comm period. Light sleep is
+    /// disabled while the uplink task runs, as it would halt the task and drop the WiFi connection.
+    void startUplink();
+    /// @brief Signals the uplink task that no more records will be queued, waits for it to finish, updates the upload policy and statistics and prunes the
+    /// data file.
+    void finishUplink();
+    /// @brief Entry point of the uplink task.
+    /// @param gateway Pointer to the Gateway.
+    static void uplinkTask(void* gateway);
+    /// @brief Uploads the queued sensor data records to the MQTT server in per-node batches until the main task is done queueing, and marks uploaded records
+    /// as such in the filesystem by setting the 'upload' flag to 1 once the server has acknowledged them. Runs in the uplink task.
     void uploadPeriod();
     /// (UNUSED)
     /// @brief Parses a node update string with the following layout: "(MAC address node)/(sample interval)/(sample rounding)/(sample offset)"
     /// @param update The node update string.
     void parseNodeUpdate(char* updateString);
 
+    /// @brief Waits until the WiFi connection is established.
+    /// @param timeoutMs Maximum time to wait in ms.
+    /// @return Whether the connection was established in time.
+    bool wifiAwaitConnection(uint32_t timeoutMs);
     /// @brief Attempts to connect to the WiFi network with the given credentials. If successful, these credentials are stored for later connections.
+    /// If the connection parameters of a previous connection to the same network are cached, a fast reconnect is attempted first, falling back to a full
+    /// connect on failure.
     /// @param SSID The SSID of the WiFi network to connect to.
     /// @param password The password of the WiFi network to connect to.
     void wifiConnect(const char* SSID, const char* password);
@@ -1,4 +1,8 @@
 #include "Commands.h"
+#include <PhaseTiming.h>
+#include <Trace.h>
+#include <logging.h>
+#include <rom/crc.h>
 
 std::optional<std::array<char, CommandParser::lineMaxLength>> CommandParser::readLine()
 {
@@ -55,6 +59,7 @@ CommandCode CommonCommands::listFiles()
     }
     file.close();
     root.close();
+    Serial.printf("Used %uKB of %uKB available on flash.\n", LittleFS.usedBytes() / 1000, LittleFS.totalBytes() / 1000);
     return COMMAND_SUCCESS;
 }
 
@@ -76,7 +81,7 @@ CommandCode printFileImpl(const char* filename, bool hex)
     {
         while (file.available())
         {
-            Serial.printf("%X", file.read());
+            Serial.printf("%02X", file.read());
         }
     }
     else
@@ -96,6 +101,74 @@ CommandCode CommonCommands::printFile(const char* filename) { return printFileIm
 
 CommandCode CommonCommands::printFileHex(const char* filename) { return printFileImpl(filename, true); }
 
+/// @brief Writes a single export frame to the serial output.
+/// @see CommonCommands::exportFile
+void writeExportFrame(char type, uint32_t offset, const uint8_t* data, uint16_t length)
+{
+    uint8_t header[1 + sizeof(offset) + sizeof(length)]{static_cast<uint8_t>(type)};
+    memcpy(&header[1], &offset, sizeof(offset));
+    memcpy(&header[1 + sizeof(offset)], &length, sizeof(length));
+    uint32_t crc{crc32_le(0, header, sizeof(header))};
+    crc = crc32_le(crc, data, length);
+    Serial.write('M');
+    Serial.write('X');
+    Serial.write(header, sizeof(header));
+    Serial.write(data, length);
+    Serial.write(reinterpret_cast<const uint8_t*>(&crc), sizeof(crc));
+}
+
+CommandCode CommonCommands::exportFile(const char* filename, const char* offset, const char* baud)
+{
+    File file{LittleFS.open(filename)};
+    if (!file)
+    {
+        Serial.printf("Could not open file '%s'.\n", filename);
+        return COMMAND_ERROR;
+    }
+    uint32_t fileSize = file.size();
+    uint32_t position = strtoul(offset, nullptr, 10);
+    uint32_t exportBaud = strtoul(baud, nullptr, 10);
+    uint32_t commandBaud{Serial.baudRate()};
+    if (exportBaud == 0)
+        exportBaud = commandBaud;
+    if (position > fileSize || !file.seek(position))
+    {
+        Serial.printf("Offset %u is beyond the end of file '%s' (%u bytes).\n", position, filename, fileSize);
+        file.close();
+        return COMMAND_ERROR;
+    }
+    uint8_t info[sizeof(fileSize) + sizeof(uint16_t) + sizeof(exportBaud)];
+    uint16_t blockSize{EXPORT_BLOCK_SIZE};
+    memcpy(&info[0], &fileSize, sizeof(fileSize));
+    memcpy(&info[sizeof(fileSize)], &blockSize, sizeof(blockSize));
+    memcpy(&info[sizeof(fileSize) + sizeof(blockSize)], &exportBaud, sizeof(exportBaud));
+    writeExportFrame('H', position, info, sizeof(info));
+    Serial.flush();
+    if (exportBaud != commandBaud)
+    {
+        Serial.updateBaudRate(exportBaud);
+        delay(EXPORT_BAUD_SWITCH_DELAY);
+    }
+    uint8_t block[EXPORT_BLOCK_SIZE];
+    while (position < fileSize)
+    {
+        uint16_t length = file.read(block, std::min<uint32_t>(sizeof(block), fileSize - position));
+        if (length == 0)
+            break;
+        writeExportFrame('B', position, block, length);
+        position += length;
+    }
+    file.close();
+    writeExportFrame('E', fileSize, nullptr, 0);
+    Serial.flush();
+    if (exportBaud != commandBaud)
+    {
+        delay(EXPORT_BAUD_SWITCH_DELAY);
+        Serial.updateBaudRate(commandBaud);
+    }
+    return COMMAND_SUCCESS;
+}
+
 CommandCode CommonCommands::removeFile(const char* filename)
 {
     if (!LittleFS.remove(filename))
@@ -121,12 +194,48 @@ CommandCode CommonCommands::touchFile(const char* filename)
 CommandCode CommonCommands::format()
 {
     Serial.println("Formatting flash memory (this can take some time)...");
+    Log::log.close();
     LittleFS.format();
     Serial.println("Restarting ...");
     ESP.restart();
     return COMMAND_SUCCESS;
 }
 
+CommandCode CommonCommands::printTiming()
+{
+    Serial.println("PHASE\tCOUNT\tMEAN (ms)\tMAX (ms)");
+    for (size_t i{0}; i < PHASE_COUNT; i++)
+    {
+        const PhaseTiming::Stats& stats{PhaseTiming::getStats(static_cast<Phase>(i))};
+        if (stats.count == 0)
+            continue;
+        Serial.printf("%s\t%u\t%.1f\t%.1f\n", PhaseTiming::getName(static_cast<Phase>(i)), stats.count, static_cast<float>(stats.totalUs) / stats.count / 1000,
+                      static_cast<float>(stats.maxUs) / 1000);
+    }
+    Serial.print("PHASE");
+    for (uint32_t bound : PhaseTiming::bounds)
+        Serial.printf("\t<= %u", bound);
+    Serial.printf("\t> %u\n", PhaseTiming::bounds.back());
+    for (size_t i{0}; i < PHASE_COUNT; i++)
+    {
+        const PhaseTiming::Stats& stats{PhaseTiming::getStats(static_cast<Phase>(i))};
+        if (stats.count == 0)
+            continue;
+        Serial.print(PhaseTiming::getName(static_cast<Phase>(i)));
+        for (uint32_t count : stats.histogram)
+            Serial.printf("\t%u", count);
+        Serial.print('\n');
+    }
+    return COMMAND_SUCCESS;
+}
+
+CommandCode CommonCommands::dumpTrace()
+{
+    Trace::dump(Serial);
+    Trace::clear();
+    return COMMAND_SUCCESS;
+}
+
 CommandCode CommonCommands::echo(const char* arg)
 {
     Serial.print(arg);
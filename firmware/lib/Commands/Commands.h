@@ -8,6 +8,8 @@
 #include <optional>
 
 #define UART_PHASE_TIMEOUT (1 * 60) // s, length of UART inactivity required to automatically exit command phase
+#define EXPORT_BLOCK_SIZE 1024       // bytes, file contents per export frame
+#define EXPORT_BAUD_SWITCH_DELAY 100 // ms, time given to the host to switch baud rate before export frames are sent at the negotiated rate
 
 enum CommandCode : uint8_t
 {
@@ -39,7 +41,7 @@ CommandAliasesPair(CommandCode (C::*&& f)(CommandArgs...), Aliases&&... aliases)
 
 struct CommonCommands
 {
-    /// @brief Lists all files currently available on the filesystem.
+    /// @brief Lists all files currently available on the filesystem, followed by the flash usage.
     CommandCode listFiles();
     /// @brief Prints the given file to the serial output.
     /// @param filename The name of the file to be printed, including slashes.
@@ -47,6 +49,14 @@ struct CommonCommands
     /// @brief Prints the given file to the serial output, interpreted in hexadecimal notation.
     /// @param filename The name of the file to be printed, including slashes.
     CommandCode printFileHex(const char* filename);
+    /// @brief Streams the given file to the serial output in binary frames, each with the following layout: "('M', 'X')(type, 1 byte)(offset, 4 bytes)(length,
+    /// 2 bytes)(data)(CRC32 of type, offset, length and data, 4 bytes)". A header frame (type 'H', data holding the file size (4 bytes), block size (2 bytes)
+    /// and baud rate (4 bytes)) is followed by data frames (type 'B') of at most EXPORT_BLOCK_SIZE bytes and an end frame (type 'E', offset set to the file
+    /// size). The header frame is sent at the current baud rate, the other frames at the requested one. Used by export_file.py.
+    /// @param filename The name of the file to be exported, including slashes.
+    /// @param offset Offset in the file to start from, used to resume an interrupted export.
+    /// @param baud Baud rate to send the data and end frames at, 0 to keep the current one.
+    CommandCode exportFile(const char* filename, const char* offset, const char* baud);
     /// @brief Removes the file from the filesystem.
     /// @param filename The name of the file to be removed.
     CommandCode removeFile(const char* filename);
@@ -55,6 +65,10 @@ struct CommonCommands
     CommandCode touchFile(const char* filename);
     /// @brief Formats the filesystem. This erases all data!
     CommandCode format();
+    /// @brief Prints the time spent in each phase of a wake since the phase timing telemetry was last stored, including duration histograms.
+    CommandCode printTiming();
+    /// @brief Dumps the event trace ring in binary to the serial output, to be converted with trace_to_chrome.py, and empties it.
+    CommandCode dumpTrace();
     /// @brief Echoes the argument to the UART output. Used for testing CLI functionality.
     /// @param arg The argument to echo.
     CommandCode echo(const char* arg);
@@ -65,9 +79,12 @@ struct CommonCommands
     {
         return std::make_tuple(
             CommandAliasesPair(&CommonCommands::listFiles, "ls", "list"), CommandAliasesPair(&CommonCommands::printFile, "print", "printfile"),
-            CommandAliasesPair(&CommonCommands::printFileHex, "printhex", "printfilehex"), CommandAliasesPair(&CommonCommands::removeFile, "rm", "remove"),
+            CommandAliasesPair(&CommonCommands::printFileHex, "printhex", "printfilehex"), CommandAliasesPair(&CommonCommands::exportFile, "export"),
+            CommandAliasesPair(&CommonCommands::removeFile, "rm", "remove"),
             CommandAliasesPair(&CommonCommands::touchFile, "touch"), CommandAliasesPair(&CommonCommands::format, "format"),
-            CommandAliasesPair(&CommonCommands::echo, "echo"), CommandAliasesPair(&CommonCommands::exit, "exit", "close"));
+            CommandAliasesPair(&CommonCommands::printTiming, "timing"), CommandAliasesPair(&CommonCommands::dumpTrace, "trace"),
+            CommandAliasesPair(&CommonCommands::echo, "echo"),
+            CommandAliasesPair(&CommonCommands::exit, "exit", "close"));
     };
 };
 
@@ -90,6 +107,8 @@ public:
     template <class C> typename std::enable_if_t<std::is_base_of_v<CommonCommands, C>, void> prompt(C&& commands);
     // @brief Forcibly sets the commandPhaseFlag to true.
     void setFlag() { commandPhaseFlag = true; };
+    /// @return Whether the command phase will be entered when prompted.
+    bool isRequested() const { return commandPhaseFlag; }
 };
 
 class CommandParser
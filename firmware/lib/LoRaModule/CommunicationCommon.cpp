@@ -1,6 +1,6 @@
 #include "CommunicationCommon.h"
 #include <algorithm>
-
+#include <cstdio>
 
 char* MACAddress::toString(char* string) const
 {
@@ -12,8 +12,8 @@ char* MACAddress::toString(char* string) const
 MACAddress MACAddress::fromString(char* string)
 {
     uint8_t address[6];
-    sscanf(string, "%02X:%02X:%02X:%02X:%02X:%02X", &address[0], &address[1], &address[2], &address[3], &address[4], &address[5]);
+    sscanf(string, "%02hhX:%02hhX:%02hhX:%02hhX:%02hhX:%02hhX", &address[0], &address[1], &address[2], &address[3], &address[4], &address[5]);
     return MACAddress(address);
 }
 const MACAddress MACAddress::broadcast{};
-char MACAddress::strBuffer[MACAddress::stringLength];
+thread_local char MACAddress::strBuffer[MACAddress::stringLength];
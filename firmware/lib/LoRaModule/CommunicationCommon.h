@@ -1,7 +1,10 @@
 #ifndef __COMM_COMM_H__
 #define __COMM_COMM_H__
 
+#include <algorithm>
 #include <array>
+#include <stddef.h>
+#include <stdint.h>
 
 #include "Sensor.h"
 
@@ -20,6 +23,7 @@ public:
     /// @brief Gets the raw byte pointer to the MAC address.
     /// @return A raw byte pointer to the MAC address.
     uint8_t* getAddress() { return address.data(); }
+    const uint8_t* getAddress() const { return address.data(); }
     /// @brief Gives a hex string representation of this MAC address.
     /// @param string Buffer to write the resulting string to. By default, this uses a static buffer.
     /// @return The buffer to which the string was written.
@@ -41,7 +45,7 @@ public:
 
 private:
     /// @brief Internal static string buffer used by the toString method.
-    static char strBuffer[stringLength];
+    static thread_local char strBuffer[stringLength];
 } __attribute__((packed));
 
 /// @brief Enum used to indicate the type of a message. Maximum of 128 available types.
@@ -55,7 +59,9 @@ enum MessageType : uint8_t
     SENSOR_DATA = 5,
     ACK_DATA = 6,
     REPEAT = 7,
-    ALL = 8
+    ALL = 8,
+    SENSOR_CONFIG = 9,
+    ACK_SENSOR_CONFIG = 10
 };
 
 /// @brief Base class providing a common interface between all message types and the header portion of the message.
@@ -91,7 +97,7 @@ public:
 
     /// @brief Converts this message in-place to a byte buffer.
     /// @return The pointer to the resulting byte buffer.
-    constexpr const uint8_t* toData() const { return reinterpret_cast<const uint8_t*>(this); }
+    const uint8_t* toData() const { return reinterpret_cast<const uint8_t*>(this); }
 
     /// @brief The length of the header in bytes.
     static constexpr size_t headerLength{1 + 2 * sizeof(MACAddress)};
@@ -114,7 +120,7 @@ public:
     /// @brief Converts a byte buffer in-place to this message type, without any runtime checking.
     /// @param data The byte buffer to interpret a message from.
     /// @return The resulting message object.
-    constexpr static Message<T>& fromData(uint8_t* data) { return *reinterpret_cast<Message<T>*>(data); }
+    static Message<T>& fromData(uint8_t* data) { return *reinterpret_cast<Message<T>*>(data); }
 } __attribute__((packed));
 
 template <> class Message<TIME_CONFIG> : public MessageHeader
@@ -143,47 +149,127 @@ public:
     /// @brief Converts a byte buffer in-place to this message type, without any runtime checking.
     /// @param data The byte buffer to interpret a message from.
     /// @return The resulting message object.
-    constexpr static Message<TIME_CONFIG>& fromData(uint8_t* data) { return *reinterpret_cast<Message<TIME_CONFIG>*>(data); }
+    static Message<TIME_CONFIG>& fromData(uint8_t* data) { return *reinterpret_cast<Message<TIME_CONFIG>*>(data); }
 } __attribute__((packed));
 
 template <> class Message<SENSOR_DATA> : public MessageHeader
 {
 private:
+    /// @brief Per-node monotonically increasing (wrapping) record sequence number, used by the gateway to drop duplicate records.
+    uint16_t seq;
     /// @brief The timestamp associated with the held values (UNIX epoch, seconds).
     uint32_t time;
     /// @brief The amount of values held in the messages' values array.
     uint8_t nValues;
 
 public:
+    /// @brief Sequence number of the records holding the values filled in by the gateway for dead-banded sensors, never used by a node.
+    static constexpr uint16_t filledSequence{UINT16_MAX};
     /// @brief The maximum amount of sensor values that can be held in a single sensor data message.
-    static const size_t maxNValues = (maxLength - headerLength - sizeof(time) - sizeof(nValues)) / sizeof(SensorValue);
+    static const size_t maxNValues = (maxLength - headerLength - sizeof(seq) - sizeof(time) - sizeof(nValues)) / sizeof(SensorValue);
 
 private:
-    std::array<SensorValue, maxNValues> values{};
+    // a plain array, as a std::array of SensorValue is not POD and would not be packed
+    SensorValue values[maxNValues]{};
 
 public:
-    Message(const MACAddress& src, const MACAddress& dest, uint32_t time, const uint8_t nValues, const std::array<SensorValue, maxNValues> values)
-        : MessageHeader(SENSOR_DATA, src, dest), time{time}, nValues{std::min(nValues, static_cast<uint8_t>(maxNValues))}, values{values} {};
+    Message(const MACAddress& src, const MACAddress& dest, uint16_t seq, uint32_t time, const uint8_t nValues,
+            const std::array<SensorValue, maxNValues> values)
+        : MessageHeader(SENSOR_DATA, src, dest), seq{seq}, time{time}, nValues{std::min(nValues, static_cast<uint8_t>(maxNValues))}
+    {
+        std::copy_n(values.begin(), this->nValues, this->values);
+    };
 
+    uint16_t getSequence() const { return seq; };
     uint32_t getCTime() const { return time; };
     uint32_t getNValues() const { return nValues; };
-    std::array<SensorValue, maxNValues>& getValues() { return values; }
+    SensorValue* getValues() { return values; }
 
     /// @return The messages' length in bytes.
-    constexpr size_t getLength() const { return headerLength + sizeof(time) + sizeof(nValues) + nValues * sizeof(SensorValue); };
+    constexpr size_t getLength() const { return headerLength + sizeof(seq) + sizeof(time) + sizeof(nValues) + nValues * sizeof(SensorValue); };
     /// @return Whether the message's type flag matches the desired type.
     constexpr bool isValid() const { return isType(SENSOR_DATA); }
     /// @brief Converts a byte buffer in-place to this message type, without any runtime checking.
     /// @param data The byte buffer to interpret a message from.
     /// @return The resulting message object.
-    static constexpr Message<SENSOR_DATA>& fromData(uint8_t* data);
+    static Message<SENSOR_DATA>& fromData(uint8_t* data);
 } __attribute__((packed));
 
-constexpr Message<SENSOR_DATA>& Message<SENSOR_DATA>::fromData(uint8_t* data)
+inline Message<SENSOR_DATA>& Message<SENSOR_DATA>::fromData(uint8_t* data)
 {
     Message<SENSOR_DATA>& m{*reinterpret_cast<Message<SENSOR_DATA>*>(data)};
     m.nValues = std::min(m.nValues, static_cast<uint8_t>(maxNValues));
     return m;
 }
 
+/// @brief Sampling schedule of a single sensor, overriding the node-wide sample interval of the time config. The sensor is sampled at every multiple of
+/// the interval (since UNIX epoch) plus the offset.
+struct SensorSchedule
+{
+    /// @brief Tag of the sensor's values (see SensorValue). The instance bits are ignored, as a sensor is scheduled as a whole.
+    uint16_t tag{0};
+    /// @brief Sample interval in seconds.
+    uint32_t interval{0};
+    /// @brief Phase offset in seconds, smaller than the interval.
+    uint32_t offset{0};
+    /// @brief If not 0, the sensor is read every readInterval seconds instead (aligned to multiples of it plus the offset), and only the statistics of the
+    /// readings of each sample interval are stored, at its end (see SensorAggregate). Must be smaller than the interval.
+    uint32_t readInterval{0};
+    /// @brief If above 0, a value of the sensor is only stored if it differs more than this from the last stored value of its tag, or if maxSilence has
+    /// passed since (see ReportedValues). The gateway fills in the values left out.
+    float deadBand{0};
+    /// @brief Maximum time in seconds between two stored values of a tag of a dead-banded sensor.
+    uint32_t maxSilence{0};
+
+    /// @return Whether this schedule applies to the sensor with the given type ID.
+    constexpr bool appliesTo(unsigned int typeTag) const { return (tag >> 4) == (typeTag & 0xFFF); }
+    /// @return Whether the sensor's readings are aggregated.
+    constexpr bool isAggregated() const { return readInterval > 0 && readInterval < interval; }
+    /// @return Whether the sensor's values are dead-banded. The statistics of aggregated sensors are always stored.
+    constexpr bool isDeadBanded() const { return deadBand > 0 && maxSilence > 0 && !isAggregated(); }
+} __attribute__((packed));
+
+template <> class Message<SENSOR_CONFIG> : public MessageHeader
+{
+private:
+    /// @brief The amount of schedules held in the message's schedules array.
+    uint8_t nSchedules;
+
+public:
+    /// @brief The maximum amount of sensor schedules that can be held in a single sensor config message.
+    static const size_t maxNSchedules = (maxLength - headerLength - sizeof(nSchedules)) / sizeof(SensorSchedule);
+
+private:
+    // a plain array, as a std::array of SensorSchedule is not POD and would not be packed
+    SensorSchedule schedules[maxNSchedules]{};
+
+public:
+    /// @brief Constructs a sensor config message holding the complete set of sensor schedules of a node. Sensors without a schedule revert to the
+    /// node-wide sample interval.
+    Message(const MACAddress& src, const MACAddress& dest, const SensorSchedule* schedules, size_t nSchedules)
+        : MessageHeader(SENSOR_CONFIG, src, dest), nSchedules{static_cast<uint8_t>(std::min(nSchedules, maxNSchedules))}
+    {
+        std::copy_n(schedules, this->nSchedules, this->schedules);
+    };
+
+    size_t getNSchedules() const { return nSchedules; };
+    const SensorSchedule* getSchedules() const { return schedules; }
+
+    /// @return The messages' length in bytes.
+    constexpr size_t getLength() const { return headerLength + sizeof(nSchedules) + nSchedules * sizeof(SensorSchedule); };
+    /// @return Whether the message's type flag matches the desired type.
+    constexpr bool isValid() const { return isType(SENSOR_CONFIG); }
+    /// @brief Converts a byte buffer in-place to this message type, without any runtime checking.
+    /// @param data The byte buffer to interpret a message from.
+    /// @return The resulting message object.
+    static Message<SENSOR_CONFIG>& fromData(uint8_t* data);
+} __attribute__((packed));
+
+inline Message<SENSOR_CONFIG>& Message<SENSOR_CONFIG>::fromData(uint8_t* data)
+{
+    Message<SENSOR_CONFIG>& m{*reinterpret_cast<Message<SENSOR_CONFIG>*>(data)};
+    m.nSchedules = std::min(m.nSchedules, static_cast<uint8_t>(maxNSchedules));
+    return m;
+}
+
 #endif
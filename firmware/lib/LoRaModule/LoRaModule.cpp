@@ -1,37 +1,108 @@
 #include "LoRaModule.h"
 
+/// @brief Whether the SX1272 was put to sleep at the end of the last wake. Cleared on initialisation, which resets it to standby.
+RTC_DATA_ATTR bool radioAsleep{false};
+
 LoRaModule::LoRaModule(const uint8_t csPin, const uint8_t rstPin, const uint8_t DIO0Pin, const uint8_t rxPin, const uint8_t txPin)
     : module{csPin, DIO0Pin, rstPin}, DIO0Pin{DIO0Pin}, SX1272(&module)
 {
     this->module.setRfSwitchPins(rxPin, txPin);
     esp_efuse_mac_get_default(this->mac.getAddress());
+}
+
+void LoRaModule::init()
+{
+    initialised = true;
+    radioAsleep = false;
+    int64_t initStart{esp_timer_get_time()};
     int state = this->begin(LORA_FREQUENCY, LORA_BANDWIDTH, LORA_SPREADING_FACTOR, LORA_CODING_RATE, LORA_SYNC_WORD, LORA_POWER, LORA_PREAMBLE_LENGHT,
                             LORA_AMPLIFIER_GAIN);
+    PhaseTiming::record(PHASE_LORA_INIT, initStart);
     if (state == RADIOLIB_ERR_NONE)
     {
-        Log::debug("LoRa init successful for ", this->getMACAddress().toString());
+        Log::debug("LoRa init successful for ", this->getMACAddress());
     }
     else
     {
         Log::error("LoRa module init failed, code: ", state);
     }
-};
+}
+
+void LoRaModule::powerDown()
+{
+    if (!initialised && radioAsleep)
+        return;
+    if (!initialised)
+        init();
+    this->sleep();
+    radioAsleep = true;
+}
+
+void IRAM_ATTR LoRaModule::dio0ISR(void* module)
+{
+    BaseType_t higherPriorityTaskWoken{pdFALSE};
+    xSemaphoreGiveFromISR(static_cast<LoRaModule*>(module)->dio0Semaphore, &higherPriorityTaskWoken);
+    if (higherPriorityTaskWoken)
+        portYIELD_FROM_ISR();
+}
+
+void LoRaModule::idle(uint32_t ms)
+{
+    if (!lightSleepEnabled)
+    {
+        vTaskDelay(pdMS_TO_TICKS(ms));
+        return;
+    }
+    esp_sleep_disable_wakeup_source(ESP_SLEEP_WAKEUP_ALL);
+    esp_sleep_enable_timer_wakeup(static_cast<uint64_t>(ms) * 1000);
+    Trace::record(TRACE_LIGHT_SLEEP_ENTER);
+    esp_light_sleep_start();
+    Trace::record(TRACE_LIGHT_SLEEP_EXIT);
+}
+
+bool LoRaModule::awaitDIO0(uint32_t timeoutMs)
+{
+    if (lightSleepEnabled)
+    {
+        esp_sleep_disable_wakeup_source(ESP_SLEEP_WAKEUP_ALL);
+        esp_sleep_enable_ext0_wakeup((gpio_num_t)this->DIO0Pin, 1);
+        if (timeoutMs > 0)
+            esp_sleep_enable_timer_wakeup(static_cast<uint64_t>(timeoutMs) * 1000);
+        Trace::record(TRACE_LIGHT_SLEEP_ENTER);
+        esp_light_sleep_start();
+        Trace::record(TRACE_LIGHT_SLEEP_EXIT);
+        esp_sleep_wakeup_cause_t wakeupCause{esp_sleep_get_wakeup_cause()};
+        return wakeupCause == ESP_SLEEP_WAKEUP_GPIO || wakeupCause == ESP_SLEEP_WAKEUP_EXT0;
+    }
+    if (dio0Semaphore == nullptr)
+        dio0Semaphore = xSemaphoreCreateBinary();
+    xSemaphoreTake(dio0Semaphore, 0); // clear stale interrupts
+    attachInterruptArg(this->DIO0Pin, dio0ISR, this, RISING);
+    bool raised{digitalRead(this->DIO0Pin) == HIGH ||
+                xSemaphoreTake(dio0Semaphore, timeoutMs > 0 ? pdMS_TO_TICKS(timeoutMs) : portMAX_DELAY) == pdTRUE};
+    detachInterrupt(this->DIO0Pin);
+    return raised;
+}
 
 void LoRaModule::sendRepeat(const MACAddress& dest)
 {
-    Log::debug("Sending REPEAT message to ", dest.toString());
+    Log::debug("Sending REPEAT message to ", dest);
+    linkCounters.repeatsSent++;
     auto repeatMessage = Message<REPEAT>(this->mac, dest);
     sendPacket(repeatMessage.toData(), repeatMessage.getLength());
 }
 
 void LoRaModule::sendPacket(const uint8_t* buffer, size_t length)
 {
-    esp_sleep_disable_wakeup_source(ESP_SLEEP_WAKEUP_ALL);
-    esp_sleep_enable_ext0_wakeup((gpio_num_t)this->DIO0Pin, 1);
+    if (!initialised)
+        init();
+    PhaseTiming::Scope timing{PHASE_RADIO_TX};
+    Trace::record(TRACE_TX_START, length);
     int state = this->startTransmit(const_cast<uint8_t*>(buffer), length);
     if (state == RADIOLIB_ERR_NONE)
     {
-        esp_light_sleep_start();
+        awaitDIO0(0);
+        Trace::record(TRACE_TX_DONE);
         Log::debug("Packet sent!");
     }
     else
@@ -49,6 +120,7 @@ void LoRaModule::resendMessage()
         esp_sleep_disable_wakeup_source(ESP_SLEEP_WAKEUP_ALL);
         return;
     }
-    Log::debug("Resending last sent message to ", this->getLastDest().toString());
+    Log::debug("Resending last sent message to ", this->getLastDest());
+    linkCounters.retransmissions++;
     sendPacket(this->sendBuffer, this->sendLength);
 }
\ No newline at end of file
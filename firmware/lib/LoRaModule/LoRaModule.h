@@ -4,7 +4,9 @@
 #include <Arduino.h>
 #include <CommunicationCommon.h>
 #include <PCF2129_RTC.h>
+#include <PhaseTiming.h>
 #include <RadioLib.h>
+#include <Trace.h>
 #include <logging.h>
 
 #include <optional>
@@ -23,6 +25,32 @@
 
 #define SEND_DELAY 500 // ms, time to wait before sending a message
 
+/// @brief Link quality of a single received frame.
+struct LinkMetrics
+{
+    /// @brief Received signal strength in dBm.
+    float rssi{0};
+    /// @brief Signal-to-noise ratio in dB.
+    float snr{0};
+    /// @brief Frequency offset between transmitter and receiver in Hz.
+    float frequencyError{0};
+};
+
+/// @brief Counters of radio events, cumulative since construction of the LoRaModule.
+struct LinkCounters
+{
+    /// @brief Frames read without error, regardless of their source or destination.
+    uint32_t framesReceived{0};
+    /// @brief Frames dropped because of a CRC mismatch.
+    uint32_t crcErrors{0};
+    /// @brief Receive windows that expired without a frame.
+    uint32_t timeouts{0};
+    /// @brief REPEAT messages sent after a timeout.
+    uint32_t repeatsSent{0};
+    /// @brief Messages resent on request of a REPEAT message.
+    uint32_t retransmissions{0};
+};
+
 /// @brief Responsible for LoRa communication and control over the SX1272 module
 class LoRaModule : public SX1272
 {
@@ -35,6 +63,23 @@ private:
     /// @brief Pin number for SX1272's DIO0 interrupt pin
     const uint8_t DIO0Pin;
 
+    /// @brief Whether the SX1272 has been initialised during this wake.
+    bool initialised{false};
+    /// @brief Resets and configures the SX1272. Done on first use of the radio, so that wakes without radio traffic (e.g. sample-only wakes) skip it.
+    void init();
+
+    /// @brief Whether the module may use light sleep while waiting on the radio. Light sleep halts both cores and the WiFi connection, so this must be
+    /// disabled while other tasks need to keep running.
+    bool lightSleepEnabled{true};
+    /// @brief Semaphore given by the DIO0 interrupt, used to wait on the radio when light sleep is disabled.
+    SemaphoreHandle_t dio0Semaphore{nullptr};
+    /// @brief DIO0 interrupt handler used when light sleep is disabled.
+    static void IRAM_ATTR dio0ISR(void* module);
+
+    /// @brief Link quality of the last frame read without error.
+    LinkMetrics lastLinkMetrics{};
+    LinkCounters linkCounters{};
+
     /// @brief Buffer for storage of messages to be sent
     uint8_t sendBuffer[MessageHeader::maxLength]{0};
     /// @brief  Length of message currently stored in sendBuffer
@@ -44,7 +89,7 @@ private:
     const MACAddress& getLastDest() { return reinterpret_cast<MessageHeader*>(sendBuffer)->getDest(); }
 
 public:
-    /// @brief Constructs a LoRaModule with the given pin parameters
+    /// @brief Constructs a LoRaModule with the given pin parameters. The SX1272 itself is only initialised on first use.
     /// @param csPin Chip select pin
     /// @param rstPin Reset pin
     /// @param DIOPin DIO0 interrupt pin
@@ -54,6 +99,21 @@ public:
 
     /// @return The local MAC address of this module.
     const MACAddress& getMACAddress() { return mac; }
+    /// @return The link quality of the last frame read without error, i.e. that of the last message returned by receiveMessage.
+    const LinkMetrics& getLastLinkMetrics() const { return lastLinkMetrics; }
+    /// @return The radio event counters of this module.
+    const LinkCounters& getLinkCounters() const { return linkCounters; }
+
+    /// @brief Enables or disables the use of light sleep while waiting on the radio. When disabled, the calling task blocks instead, leaving the other
+    /// core (and WiFi) running.
+    void setLightSleep(bool enable) { this->lightSleepEnabled = enable; }
+    /// @brief Idles for the given time, using light sleep if enabled.
+    /// @param ms Time to idle in ms.
+    void idle(uint32_t ms);
+    /// @brief Idles until the DIO0 pin is raised or the timeout expires, using light sleep if enabled.
+    /// @param timeoutMs Maximum time to idle in ms.
+    /// @return Whether DIO0 was raised before the timeout.
+    bool awaitDIO0(uint32_t timeoutMs);
 
     /// @brief
     /// @tparam T Type of the message to be sent. Must be of the enum MessageType.
@@ -69,6 +129,9 @@ public:
     void sendPacket(const uint8_t* buffer, size_t length);
     /// @brief Resends the last sent message stored in the sendBuffer. If there is none, does nothing.
     void resendMessage();
+    /// @brief Puts the SX1272 to sleep before deep sleep. If it was not used during this wake, it is still asleep (with its configuration retained) from
+    /// the previous wake and is left untouched.
+    void powerDown();
 
     /// @brief Receives a specific type of message from a specific source. When timing out, sends a REPEAT message according to the repeatAttempts parameter.
     /// @tparam T Desired type of the message
@@ -0,0 +1,103 @@
+#ifndef __SENSOR_DATA_BATCH_H__
+#define __SENSOR_DATA_BATCH_H__
+
+#include "CommunicationCommon.h"
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <vector>
+
+/// @brief Codec of the batched sensor data payloads uploaded by the gateway over MQTT. Each payload starts with its format (see Format), on which the decoder
+/// dispatches. The BATCH format has the following layout: "(format, 1 byte)(record count, 1 byte)(record length, 1 byte)(record)(record length, 1 byte)
+/// (record)...". Each record is a sensor data message without its header.
+/// Shared by the gateway, which encodes the batches, and the server's ingest service, which decodes them through a Python extension module.
+class SensorDataBatch
+{
+public:
+    SensorDataBatch() = delete;
+
+    /// @brief Payload formats known to the decoder, stored in the first byte of each payload. New (e.g. compressed) formats are added here, with their own
+    /// case in decode().
+    enum Format : uint8_t
+    {
+        /// @brief The record batch described above.
+        BATCH = 0
+    };
+    /// @brief Length of the header of a BATCH payload (format and record count) in bytes.
+    static constexpr size_t headerLength{2};
+
+    /// @brief Starts an empty batch.
+    /// @param payload Buffer to hold the batch, cleared.
+    static void begin(std::vector<uint8_t>& payload) { payload.assign({BATCH, 0}); }
+    /// @return The amount of records in a batch.
+    static uint8_t getNRecords(const std::vector<uint8_t>& payload) { return payload[1]; }
+
+    /// @brief Appends a record to a batch. The caller checks the record count stays below UINT8_MAX.
+    /// @param payload Batch to append to.
+    /// @param record Pointer to the sensor data message following its header.
+    /// @param length Length of the record in bytes.
+    static void append(std::vector<uint8_t>& payload, const uint8_t* record, uint8_t length)
+    {
+        payload.push_back(length);
+        payload.insert(payload.end(), record, record + length);
+        payload[1]++;
+    }
+
+    /// @brief Decodes a payload according to its format, calling a function for each of its records.
+    /// @param payload The payload.
+    /// @param length Length of the payload in bytes.
+    /// @param onRecord Function called with each valid record as a Message<SENSOR_DATA>&, of which the header is zeroed.
+    /// @return The amount of records that were skipped because their length does not match their value count, or because the payload is truncated.
+    /// SIZE_MAX if the format is unknown.
+    template <typename F> static size_t decode(const uint8_t* payload, size_t length, F&& onRecord)
+    {
+        if (length == 0)
+            return 0;
+        switch (payload[0])
+        {
+        case BATCH:
+            return decodeBatch(payload, length, onRecord);
+        default:
+            return SIZE_MAX;
+        }
+    }
+
+private:
+    /// @brief Decodes a BATCH payload, see decode().
+    template <typename F> static size_t decodeBatch(const uint8_t* payload, size_t length, F&& onRecord)
+    {
+        if (length < SensorDataBatch::headerLength)
+            return 0;
+        constexpr size_t headerLength{MessageHeader::headerLength};
+        size_t invalid{0};
+        size_t position{SensorDataBatch::headerLength};
+        uint8_t buffer[sizeof(Message<SENSOR_DATA>)]{};
+        for (size_t i{0}; i < payload[1]; i++)
+        {
+            if (position >= length || position + 1 + payload[position] > length)
+                return invalid + payload[1] - i;
+            uint8_t recordLength{payload[position]};
+            const uint8_t* record{&payload[position + 1]};
+            position += 1 + recordLength;
+            if (headerLength + recordLength > sizeof(buffer))
+            {
+                invalid++;
+                continue;
+            }
+            memcpy(&buffer[headerLength], record, recordLength);
+            // zero the remainder so a record too short for its fixed fields does not reuse a previous record's bytes
+            memset(&buffer[headerLength + recordLength], 0, sizeof(buffer) - headerLength - recordLength);
+            auto& message{Message<SENSOR_DATA>::fromData(buffer)};
+            if (message.getLength() != headerLength + recordLength)
+            {
+                invalid++;
+                continue;
+            }
+            onRecord(message);
+        }
+        return invalid;
+    }
+};
+
+#endif
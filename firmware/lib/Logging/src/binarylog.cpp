@@ -0,0 +1,88 @@
+#include "binarylog.h"
+#include <cstring>
+#include <esp_attr.h>
+
+/// @brief Write position and sequence number of the current sector, retained through deep sleep to avoid rescanning the partition on every wake.
+struct BinaryLogPosition
+{
+    bool valid{false};
+    uint32_t offset{0};
+    uint32_t sequence{0};
+};
+RTC_DATA_ATTR BinaryLogPosition binaryLogPosition;
+
+bool BinaryLog::begin()
+{
+    partition = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, static_cast<esp_partition_subtype_t>(BINARY_LOG_SUBTYPE), BINARY_LOG_PARTITION);
+    if (partition == nullptr)
+        return false;
+    if (!binaryLogPosition.valid || binaryLogPosition.offset >= partition->size)
+        recover();
+    return true;
+}
+
+void BinaryLog::recover()
+{
+    size_t sectors{partition->size / sectorSize};
+    bool found{false};
+    size_t current{0};
+    uint32_t sequence{0};
+    for (size_t i{0}; i < sectors; i++)
+    {
+        uint32_t header;
+        esp_partition_read(partition, i * sectorSize, &header, sizeof(header));
+        if (header != UINT32_MAX && (!found || header > sequence))
+        {
+            found = true;
+            current = i;
+            sequence = header;
+        }
+    }
+    if (!found)
+    {
+        // empty partition: start at the first sector
+        binaryLogPosition.sequence = UINT32_MAX;
+        binaryLogPosition.offset = partition->size;
+        nextSector();
+        binaryLogPosition.valid = true;
+        return;
+    }
+    size_t offset{current * sectorSize + sizeof(uint32_t)};
+    uint8_t header[2];
+    while (offset + sizeof(header) <= (current + 1) * sectorSize)
+    {
+        esp_partition_read(partition, offset, header, sizeof(header));
+        if (header[0] != sync || header[1] < headerLength)
+            break;
+        offset += header[1];
+    }
+    binaryLogPosition.sequence = sequence;
+    binaryLogPosition.offset = offset;
+    binaryLogPosition.valid = true;
+}
+
+void BinaryLog::nextSector()
+{
+    // the write position is always past the header of the current sector
+    size_t sector{((binaryLogPosition.offset - 1) / sectorSize + 1) % (partition->size / sectorSize)};
+    binaryLogPosition.offset = sector * sectorSize;
+    binaryLogPosition.sequence++;
+    esp_partition_erase_range(partition, binaryLogPosition.offset, sectorSize);
+    esp_partition_write(partition, binaryLogPosition.offset, &binaryLogPosition.sequence, sizeof(binaryLogPosition.sequence));
+    binaryLogPosition.offset += sizeof(binaryLogPosition.sequence);
+}
+
+void BinaryLog::write(uint8_t* record, size_t length, uint8_t level, uint32_t time)
+{
+    if (!ready() || length > maxRecordLength)
+        return;
+    record[0] = sync;
+    record[1] = length;
+    memcpy(&record[2], &time, sizeof(time));
+    record[6] = level;
+    size_t sectorOffset{binaryLogPosition.offset % sectorSize};
+    if (sectorOffset == 0 || sectorOffset + length > sectorSize)
+        nextSector();
+    esp_partition_write(partition, binaryLogPosition.offset, record, length);
+    binaryLogPosition.offset += length;
+}
@@ -0,0 +1,48 @@
+#ifndef __BINARY_LOG_H__
+#define __BINARY_LOG_H__
+
+#include <esp_partition.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define BINARY_LOG_PARTITION "binlog" // name of the raw data partition holding the binary log ring
+#define BINARY_LOG_SUBTYPE 0x40       // custom data subtype of the binary log partition
+
+/// @brief Ring of binary log records in a raw flash partition, written without formatting. Records are rendered to text offline by decode_binlog.py.
+///
+/// The partition is divided in sectors, each starting with a 4-byte sequence number so that the oldest sector can be found after a wrap. Records never span
+/// sectors and have the following layout: "(sync, 1 byte)(record length, 1 byte)(time, 4 bytes)(level, 1 byte)(argument)...", where each argument is a kind
+/// character followed by its raw bytes:
+///  - 'P': string literal, stored as its 4-byte address in flash (rodata), which serves as compile-time message ID and is resolved from the firmware ELF.
+///  - 'S': string in RAM, stored as a 1-byte length followed by the characters.
+///  - 'i', 'u', 'f': 4-byte signed integer, unsigned integer or float.
+///  - 'c': single character.
+class BinaryLog
+{
+public:
+    static constexpr uint8_t sync{0xA5};
+    static constexpr size_t headerLength{1 + 1 + 4 + 1};
+    static constexpr size_t maxRecordLength{128};
+
+    /// @brief Locates the partition and recovers the write position, from RTC memory after deep sleep or by scanning the sector headers otherwise.
+    /// @return Whether the binary log partition was found.
+    bool begin();
+    /// @return Whether begin was successful.
+    bool ready() const { return partition != nullptr; }
+    /// @brief Completes the record header and appends the record to the ring.
+    /// @param record The record, starting with headerLength bytes of room for the header.
+    /// @param length Length of the record in bytes, including the header.
+    /// @param level Log level of the record.
+    /// @param time Time of the record (UNIX epoch, seconds).
+    void write(uint8_t* record, size_t length, uint8_t level, uint32_t time);
+
+private:
+    static constexpr size_t sectorSize{4096};
+    const esp_partition_t* partition{nullptr};
+    /// @brief Moves the write position to the start of the next sector, erasing it.
+    void nextSector();
+    /// @brief Scans the partition for the most recently written sector and the end of its records.
+    void recover();
+};
+
+#endif
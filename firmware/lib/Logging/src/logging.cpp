@@ -36,28 +36,29 @@ void Log::removeOldLogfiles(struct tm& time)
     root.close();
 }
 
-void Log::openLogfile(const struct tm& time)
+void Log::openLogfile(struct tm& time)
 {
     char logfilePath[32];
     generateLogfilePath(logfilePath, time);
-    if (LittleFS.exists(logfilePath))
-    {
-        this->logfile = LittleFS.open(logfilePath, "a");
-    }
-    else
-    {
-        this->logfile = LittleFS.open(logfilePath, "w", true);
-    }
+    bool created{!LittleFS.exists(logfilePath)};
+    this->logfile = LittleFS.open(logfilePath, created ? "w" : "a", created);
     this->logfileTime = time;
     if (!this->logfile)
     {
         this->logfileEnabled = false;
         this->error("Unable to open/create logfile! Log will disable logging to file.");
+        return;
     }
+    // logfiles only expire when the date changes, i.e. when a new logfile is created
+    if (created)
+        removeOldLogfiles(time);
 }
 
 void Log::manageLogfile(struct tm& time)
 {
+#ifdef LOG_BINARY
+    return; // the binary log ring replaces the logfile
+#endif
     if (!this->logfileEnabled)
         return;
     if ((this->logfileTime.tm_mday != time.tm_mday) || (this->logfileTime.tm_mon != time.tm_mon) || (this->logfileTime.tm_year != time.tm_year) ||
@@ -66,21 +67,62 @@ void Log::manageLogfile(struct tm& time)
         if (this->logfile)
             this->logfile.close();
         openLogfile(time);
-        if (!this->logfile)
-            return;
-        removeOldLogfiles(time);
     }
 }
 
-void Log::logfilePrint()
+void Log::logfilePrint(const tm& time)
 {
+#ifdef LOG_BINARY
+    return;
+#endif
     if (!this->logfileEnabled)
         return;
-    this->logfile.println(buffer);
+    size_t length{strlen(buffer)};
+    if (logfileBuffered + length + 1 > logfileBufferSize ||
+        (logfileBuffered > 0 && (stagedTime.tm_mday != time.tm_mday || stagedTime.tm_mon != time.tm_mon || stagedTime.tm_year != time.tm_year)))
+    {
+        // opening the logfile may log itself, overwriting the buffer
+        char line[sizeof(buffer)];
+        memcpy(line, buffer, length + 1);
+        flush();
+        memcpy(buffer, line, length + 1);
+        // the logfile may have failed to open, which disables it and drops the staged lines
+        if (!this->logfileEnabled || logfileBuffered + length + 1 > logfileBufferSize)
+            return;
+    }
+    if (logfileBuffered == 0)
+        stagedTime = time;
+    memcpy(&logfileBuffer[logfileBuffered], buffer, length);
+    logfileBuffered += length;
+    logfileBuffer[logfileBuffered++] = '\n';
+    logfileLines++;
+}
+
+void Log::flush()
+{
+    std::lock_guard<std::recursive_mutex> lock{mutex};
+    if (logfileBuffered == 0)
+        return;
+    // the logfile is only opened once there is something to write to it
+    manageLogfile(stagedTime);
+    if (!this->logfile)
+    {
+        // the staged lines can not be written, drop them so that the buffer does not overflow
+        logfileBuffered = 0;
+        return;
+    }
+    this->logfile.write(reinterpret_cast<const uint8_t*>(logfileBuffer), logfileBuffered);
+    this->logfile.flush();
+    logfileBuffered = 0;
+    logfileFlushes++;
 }
 
 void Log::close()
 {
+    std::lock_guard<std::recursive_mutex> lock{mutex};
+    if (logfileLines > 0)
+        this->info("Logfile: ", logfileLines, " lines written in ", logfileFlushes + 1, " flushes this wake.");
+    flush();
     this->logfile.close();
     this->logfileEnabled = false;
 }
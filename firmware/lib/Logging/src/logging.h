@@ -4,7 +4,22 @@
 #include <FS.h>
 #include <HardwareSerial.h>
 #include <LittleFS.h>
+#include <array>
+#include <mutex>
 #include <type_traits>
+#include <utility>
+
+#ifndef LOG_MIN_LEVEL
+#define LOG_MIN_LEVEL Log::DEBUG // compile-time minimum level, set per build environment (e.g. -DLOG_MIN_LEVEL=Log::INFO)
+#endif
+
+#ifdef LOG_BINARY // log to a binary ring in flash instead of a text logfile, see BinaryLog
+#include "binarylog.h"
+#include <soc/soc_memory_layout.h>
+#ifndef LOG_BINARY_SERIAL_LEVEL
+#define LOG_BINARY_SERIAL_LEVEL Log::ERROR // messages below this level are not formatted for the serial in binary mode
+#endif
+#endif
 
 class Log
 {
@@ -28,10 +43,30 @@ private:
     bool logfileEnabled{false};
     /// @brief Time struct of the currently loaded logging file.
     tm logfileTime{0};
+    /// @brief Time struct of the first line staged in the logfile buffer. All staged lines belong to the logfile of its date.
+    tm stagedTime{0};
     /// @brief Currently loaded logging file. Should be opened in append mode.
     File logfile{};
     /// @brief Days to keep a logging file in the filesystem.
     static constexpr size_t daysToKeep{7};
+    /// @brief Size of the logfile buffer, equal to a flash page, so that each flush results in a single page-sized append.
+    static constexpr size_t logfileBufferSize{4096};
+    /// @brief Buffer in which logfile lines are staged before being written to the logfile.
+    char logfileBuffer[logfileBufferSize]{0};
+    /// @brief Amount of bytes staged in the logfile buffer.
+    size_t logfileBuffered{0};
+    /// @brief Amount of lines and flushes (i.e. flash write operations) to the logfile during this wake.
+    size_t logfileLines{0}, logfileFlushes{0};
+#ifdef LOG_BINARY
+    /// @brief Binary log ring, used instead of the logfile.
+    BinaryLog binaryLog{};
+    /// @brief Appends the raw bytes of an argument to a binary record, if there is room left.
+    /// @param record The binary record.
+    /// @param length Current length of the record, updated with the length of the argument.
+    template <class T> static void encodeArgument(uint8_t* record, size_t& length, T arg);
+    /// @brief Writes a binary record with the given arguments to the binary log ring.
+    template <class... Ts> void printBinary(Level level, uint32_t time, Ts... args);
+#endif
 
     /// @brief Generates a logfile path from a time struct.
     /// @param buffer Buffer to which to write the logfile path.
@@ -40,17 +75,21 @@ private:
     /// @brief Removes all logfiles that have reached the expiry date by a given date.
     /// @param time Date from which logfile expiration is calculated according to daysToKeep.
     void removeOldLogfiles(struct tm& time);
-    /// @brief Opens/creates a logfile with the given date.
+    /// @brief Opens/creates a logfile with the given date. Expired logfiles are removed whenever a new logfile is created.
     /// @param time The date for which to open/create a logfile.
-    void openLogfile(const struct tm& time);
-    /// @brief Manages all file-related operations for a given date.
+    void openLogfile(struct tm& time);
+    /// @brief Manages all file-related operations for a given date. Only called when flushing, so that the logfile is not opened during wakes that do not
+    /// write to it.
     /// @param time The date from which to manage the filesystem.
     void manageLogfile(struct tm& time);
-    /// @brief Prints the current buffer to the currently open logfile.
-    void logfilePrint();
+    /// @brief Stages the current buffer in the logfile buffer, flushing first if it is full or if the staged lines are of another date.
+    /// @param time The time of the current buffer.
+    void logfilePrint(const tm& time);
 
     /// @brief Buffer in which the final string is constructed and printed from.
     char buffer[256]{0};
+    /// @brief Guards the buffer and logfile, so that multiple tasks can log concurrently. Recursive, as managing the logfile may itself log.
+    std::recursive_mutex mutex{};
     /// @brief Prints the preamble portion of the log line.
     /// @tparam level The level displayed in the preamble.
     /// @param time The time displayed in the preamble.
@@ -63,13 +102,41 @@ private:
     template <class T> static constexpr std::string_view rawTypeToFormatSpecifier();
     /// @return A format string matched to the given type arguments.
     template <class... Ts> static constexpr auto createFormatString();
+    /// @brief Whether a type is formatted lazily, i.e. only when the message is actually printed, through its "char* toString(char*) const" method.
+    template <class T, class = void> struct isLazy : std::false_type
+    {
+    };
+    template <class T> struct isLazy<T, std::void_t<decltype(std::declval<const T&>().toString(std::declval<char*>()))>> : std::true_type
+    {
+    };
+    /// @brief Size of the buffer in which a lazily formatted argument is written.
+    static constexpr size_t lazyStringLength{32};
+    /// @brief Maximum amount of lazily formatted arguments of a single message, bounding the stack used by their buffers.
+    static constexpr size_t maxLazyArguments{4};
+    /// @return The amount of lazily formatted arguments among the given types.
+    template <class... Ts> static constexpr size_t lazyCount() { return (size_t{isLazy<Ts>::value} + ... + 0); }
+    /// @return The index of the buffer of argument I among the lazily formatted arguments.
+    template <size_t I, class... Ts> static constexpr size_t lazyIndex()
+    {
+        constexpr std::array<bool, sizeof...(Ts)> lazy{isLazy<Ts>::value...};
+        size_t index{0};
+        for (size_t i{0}; i < I; i++)
+            index += lazy[i];
+        return index;
+    }
+    /// @return The argument itself, or its string representation (written to the buffer) if it is formatted lazily.
+    template <class T> static decltype(auto) evaluate(const T& arg, char* buffer);
+    /// @brief Evaluates lazily formatted arguments and prints them.
+    template <Level level, class... Ts, size_t... Is> void printLazy(std::index_sequence<Is...>, const Ts&... args);
     /// @brief Type-safe variadic print function. Uses compile-time format string instantiation to ensure safety in using printf.
     /// @param buffer Buffer to which to print.
     /// @param max Max number of characters to print to buffer.
     template <class... Ts> void printv(char* buffer, size_t max, Ts... args);
     /// @brief Prints to the logging buffer and forwards to (if enabled) the output serial and logfile.
     /// @tparam level Log level of printed message.
-    template <Level level, class... Ts> void print(Ts... args);
+    template <Level level, class... Ts> void print(const Ts&... args);
+    /// @brief Prints evaluated arguments.
+    template <Level level, class... Ts> void printEvaluated(Ts... args);
 
 public:
     /// @param logSerial HardwareSerial object to print to.
@@ -82,11 +149,37 @@ public:
     /// @brief Singleton global log object
     static Log log;
 
-    template <class... Ts> static void debug(Ts... args) { log.print<DEBUG>(args...); }
-    template <class... Ts> static void info(Ts... args) { log.print<INFO>(args...); }
-    template <class... Ts> static void error(Ts... args) { log.print<ERROR>(args...); }
+    // Messages below the compile-time minimum level are removed entirely. Arguments are taken by reference, so expensive conversions (e.g. of MAC addresses)
+    // are best left to Log by passing the object itself, which is then only formatted when the message is printed.
+    template <Level moduleLevel = LOG_MIN_LEVEL, class... Ts> static void debug(const Ts&... args)
+    {
+        if constexpr (DEBUG >= moduleLevel)
+            log.print<DEBUG>(args...);
+    }
+    template <Level moduleLevel = LOG_MIN_LEVEL, class... Ts> static void info(const Ts&... args)
+    {
+        if constexpr (INFO >= moduleLevel)
+            log.print<INFO>(args...);
+    }
+    template <Level moduleLevel = LOG_MIN_LEVEL, class... Ts> static void error(const Ts&... args)
+    {
+        if constexpr (ERROR >= moduleLevel)
+            log.print<ERROR>(args...);
+    }
+
+    /// @brief Logger of a single module with its own compile-time minimum level, declared in its source file, e.g.
+    /// "static constexpr Log::Module<Log::DEBUG> moduleLog{};". The level is passed explicitly with every call, so modules with different levels never
+    /// share an instantiation.
+    template <Level moduleLevel> struct Module
+    {
+        template <class... Ts> static void debug(const Ts&... args) { Log::debug<moduleLevel>(args...); }
+        template <class... Ts> static void info(const Ts&... args) { Log::info<moduleLevel>(args...); }
+        template <class... Ts> static void error(const Ts&... args) { Log::error<moduleLevel>(args...); }
+    };
 
-    /// @brief Closes the logging module, releasing the logging file.
+    /// @brief Writes the staged lines to the logfile. Done automatically when the logfile buffer fills up, after error messages and on close.
+    void flush();
+    /// @brief Closes the logging module, flushing and releasing the logging file. Must be called before deep sleep.
     void close();
 
     Log(const Log&) = delete;
@@ -153,6 +246,8 @@ template <> constexpr std::string_view Log::rawTypeToFormatSpecifier<char*>() {
 template <> constexpr std::string_view Log::rawTypeToFormatSpecifier<signed int>() { return "%i"; };
 template <> constexpr std::string_view Log::rawTypeToFormatSpecifier<unsigned int>() { return "%u"; };
 template <> constexpr std::string_view Log::rawTypeToFormatSpecifier<long signed int>() { return "%i"; };
+template <> constexpr std::string_view Log::rawTypeToFormatSpecifier<signed short>() { return "%i"; };
+template <> constexpr std::string_view Log::rawTypeToFormatSpecifier<unsigned short>() { return "%u"; };
 template <> constexpr std::string_view Log::rawTypeToFormatSpecifier<signed char>() { return "%i"; };
 template <> constexpr std::string_view Log::rawTypeToFormatSpecifier<unsigned char>() { return "%u"; };
 template <> constexpr std::string_view Log::rawTypeToFormatSpecifier<float>() { return "%f"; };
@@ -170,23 +265,135 @@ template <class... Ts> constexpr auto Log::createFormatString()
     return fmt;
 }
 
+#ifdef LOG_BINARY
+template <class T> void Log::encodeArgument(uint8_t* record, size_t& length, T arg)
+{
+    using rawType = std::remove_cv_t<std::remove_reference_t<T>>;
+    // enums are stored as their underlying type
+    using valueType = typename std::conditional_t<std::is_enum_v<rawType>, std::underlying_type<rawType>, std::enable_if<true, rawType>>::type;
+    constexpr size_t left{BinaryLog::maxRecordLength};
+    if constexpr (std::is_same_v<rawType, const char*> || std::is_same_v<rawType, char*>)
+    {
+        if (esp_ptr_in_drom(arg))
+        {
+            if (length + 1 + sizeof(arg) > left)
+                return;
+            record[length++] = 'P';
+            memcpy(&record[length], &arg, sizeof(arg));
+            length += sizeof(arg);
+            return;
+        }
+        if (length + 2 > left)
+            return;
+        size_t stringLength{std::min(strlen(arg), left - length - 2)};
+        record[length++] = 'S';
+        record[length++] = stringLength;
+        memcpy(&record[length], arg, stringLength);
+        length += stringLength;
+    }
+    else if constexpr (std::is_same_v<rawType, char>)
+    {
+        if (length + 2 > left)
+            return;
+        record[length++] = 'c';
+        record[length++] = arg;
+    }
+    else
+    {
+        if (length + 5 > left)
+            return;
+        if constexpr (std::is_floating_point_v<valueType>)
+        {
+            float value{static_cast<float>(arg)};
+            record[length++] = 'f';
+            memcpy(&record[length], &value, sizeof(value));
+        }
+        else if constexpr (std::is_signed_v<valueType>)
+        {
+            int32_t value{static_cast<int32_t>(arg)};
+            record[length++] = 'i';
+            memcpy(&record[length], &value, sizeof(value));
+        }
+        else
+        {
+            uint32_t value{static_cast<uint32_t>(arg)};
+            record[length++] = 'u';
+            memcpy(&record[length], &value, sizeof(value));
+        }
+        length += 4;
+    }
+}
+
+template <class... Ts> void Log::printBinary(Level level, uint32_t time, Ts... args)
+{
+    if (!this->logfileEnabled)
+        return;
+    if (!binaryLog.ready() && !binaryLog.begin())
+    {
+        this->logfileEnabled = false;
+        this->error("Binary log partition not found! Log will disable logging to file.");
+        return;
+    }
+    uint8_t record[BinaryLog::maxRecordLength];
+    size_t length{BinaryLog::headerLength};
+    (encodeArgument(record, length, args), ...);
+    binaryLog.write(record, length, level, time);
+}
+#endif
+
 template <class... Ts> void Log::printv(char* buffer, size_t max, Ts... args)
 {
     constexpr auto fmt{createFormatString<Ts...>()};
     snprintf(buffer, max, fmt.data(), args...);
 }
-template <Log::Level level, class... Ts> void Log::print(Ts... args)
+template <class T> decltype(auto) Log::evaluate(const T& arg, char* buffer)
+{
+    if constexpr (isLazy<T>::value)
+        return static_cast<const char*>(arg.toString(buffer));
+    else
+        return arg;
+}
+
+template <Log::Level level, class... Ts, size_t... Is> void Log::printLazy(std::index_sequence<Is...>, const Ts&... args)
+{
+    constexpr size_t nLazy{lazyCount<Ts...>()};
+    static_assert(nLazy <= maxLazyArguments, "Too many lazily formatted arguments in a single message.");
+    if constexpr (nLazy == 0)
+    {
+        printEvaluated<level>(args...);
+    }
+    else
+    {
+        char buffers[nLazy][lazyStringLength];
+        printEvaluated<level>(evaluate(args, buffers[lazyIndex<Is, Ts...>()])...);
+    }
+}
+
+template <Log::Level level, class... Ts> void Log::print(const Ts&... args)
 {
     if (level < this->level)
         return;
+    printLazy<level>(std::index_sequence_for<Ts...>{}, args...);
+}
+
+template <Log::Level level, class... Ts> void Log::printEvaluated(Ts... args)
+{
+    std::lock_guard<std::recursive_mutex> lock{mutex};
     time_t ctime{time(nullptr)};
-    tm* time{gmtime(&ctime)};
-    manageLogfile(*time);
-    size_t cur{printPreamble<level>(*time)};
+#ifdef LOG_BINARY
+    printBinary(level, static_cast<uint32_t>(ctime), args...);
+    if (level < LOG_BINARY_SERIAL_LEVEL)
+        return;
+#endif
+    tm time;
+    gmtime_r(&ctime, &time);
+    size_t cur{printPreamble<level>(time)};
     size_t left{sizeof(buffer) - cur};
     printv(&buffer[cur], left, args...);
-    logfilePrint();
+    logfilePrint(time);
     logSerial->println(buffer);
+    if constexpr (level == ERROR)
+        flush();
 }
 
 #endif
\ No newline at end of file
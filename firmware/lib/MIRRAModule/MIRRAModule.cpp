@@ -2,6 +2,7 @@
 
 void MIRRAModule::prepare(const MIRRAPins& pins)
 {
+    PhaseTiming::record(PHASE_BOOT, 0);
     Serial.begin(115200);
     Serial.println("Serial initialised.");
     gpio_hold_dis(static_cast<gpio_num_t>(pins.peripheralPowerPin));
@@ -10,7 +11,10 @@ void MIRRAModule::prepare(const MIRRAPins& pins)
     Wire.begin(pins.sdaPin, pins.sclPin); // i2c
     pinMode(pins.bootPin, INPUT);
     Serial.println("I2C wire initialised.");
-    if (!LittleFS.begin())
+    int64_t mountStart{esp_timer_get_time()};
+    bool mounted{LittleFS.begin()};
+    PhaseTiming::record(PHASE_LITTLEFS, mountStart);
+    if (!mounted)
     {
         Serial.println("Mounting LittleFS failed! Formatting and restarting ...");
         LittleFS.format();
@@ -22,7 +26,7 @@ void MIRRAModule::prepare(const MIRRAPins& pins)
 void MIRRAModule::end()
 {
     Log::log.close();
-    lora.sleep();
+    lora.powerDown();
     LittleFS.end();
     Wire.end();
     digitalWrite(pins.peripheralPowerPin, LOW);
@@ -37,14 +41,16 @@ MIRRAModule::MIRRAModule(const MIRRAPins& pins)
     Log::log.setLogfile(true);
     Log::log.setLogLevel(LOG_LEVEL);
     Serial.println("Logger initialised.");
-    Log::info("Used ", LittleFS.usedBytes() / 1000, "KB of ", LittleFS.totalBytes() / 1000, "KB available on flash.");
 }
 
 void MIRRAModule::storeSensorData(const Message<SENSOR_DATA>& m, File& dataFile)
 {
+    PhaseTiming::Scope timing{PHASE_FLASH};
+    Trace::record(TRACE_FLASH_BEGIN, m.getLength());
     dataFile.write(static_cast<uint8_t>(m.getLength()));
     dataFile.write(0); // mark not uploaded (yet)
     dataFile.write(&m.toData()[1], m.getLength() - 1);
+    Trace::record(TRACE_FLASH_END);
 }
 
 void MIRRAModule::pruneSensorData(File&& dataFile, uint32_t maxSize)
@@ -52,6 +58,8 @@ void MIRRAModule::pruneSensorData(File&& dataFile, uint32_t maxSize)
     size_t fileSize = dataFile.size();
     if (fileSize <= maxSize)
         return;
+    PhaseTiming::Scope timing{PHASE_FLASH};
+    Trace::record(TRACE_FLASH_BEGIN);
 
     char fileName[strlen(dataFile.name()) + 2];
     snprintf(fileName, strlen(dataFile.name()) + 2, "/%s", dataFile.name());
@@ -82,23 +90,32 @@ void MIRRAModule::pruneSensorData(File&& dataFile, uint32_t maxSize)
     dataFileTemp.close();
 
     LittleFS.rename(tempFileName, fileName);
+    Trace::record(TRACE_FLASH_END);
 }
 
-void MIRRAModule::deepSleep(uint32_t sleepTime)
+Message<SENSOR_DATA> MIRRAModule::phaseTimingMessage(const MACAddress& dest, uint16_t sequence, uint32_t time)
+{
+    std::array<SensorValue, Message<SENSOR_DATA>::maxNValues> values;
+    size_t nValues{PhaseTiming::emit(values.data(), values.size())};
+    return Message<SENSOR_DATA>(lora.getMACAddress(), dest, sequence, time, static_cast<uint8_t>(nValues), values);
+}
+
+void MIRRAModule::deepSleep(uint32_t sleepTime, uint32_t timerSleepTime)
 {
     if (sleepTime <= 0)
     {
         Log::error("Sleep time was zero or negative! Sleeping one second to avert crisis.");
-        return deepSleep(1);
+        return deepSleep(1, timerSleepTime);
     }
 
+    int64_t sleepStart{esp_timer_get_time()};
     esp_sleep_disable_wakeup_source(ESP_SLEEP_WAKEUP_ALL);
     // The external RTC only has a alarm resolution of 1s, to be more accurate for times lower than 10s the internal oscillator will be used to wake from deep
     // sleep
-    if (sleepTime <= 30)
+    if (sleepTime <= DEEP_SLEEP_RTC_THRESHOLD)
     {
         Log::debug("Using internal timer for deep sleep.");
-        esp_sleep_enable_timer_wakeup((uint64_t)sleepTime * 1000 * 1000);
+        esp_sleep_enable_timer_wakeup((uint64_t)(timerSleepTime != 0 ? std::min(sleepTime, timerSleepTime) : sleepTime) * 1000 * 1000);
     }
     else
     {
@@ -106,23 +123,31 @@ void MIRRAModule::deepSleep(uint32_t sleepTime)
         rtc.writeAlarm(rtc.readTimeEpoch() + sleepTime);
         rtc.enableAlarm();
         esp_sleep_enable_ext0_wakeup((gpio_num_t)rtc.getIntPin(), 0);
+        if (timerSleepTime != 0)
+            esp_sleep_enable_timer_wakeup((uint64_t)timerSleepTime * 1000 * 1000);
     }
     esp_sleep_enable_ext1_wakeup((gpio_num_t)_BV(this->pins.bootPin), ESP_EXT1_WAKEUP_ALL_LOW); // wake when BOOT button is pressed
     Log::info("Good night.");
     this->end();
+    PhaseTiming::record(PHASE_SLEEP, sleepStart);
+    PhaseTiming::record(PHASE_WAKE, 0);
+    if (sampleOnlyWake)
+        PhaseTiming::record(PHASE_SAMPLE_WAKE, 0);
     esp_deep_sleep_start();
 }
 
-void MIRRAModule::deepSleepUntil(uint32_t untilTime)
+void MIRRAModule::deepSleepUntil(uint32_t untilTime, uint32_t timerUntilTime)
 {
     uint32_t cTime{rtc.getSysTime()};
+    // a timer wake that is already due still has to wake, 1s from now
+    uint32_t timerSleepTime{timerUntilTime == 0 ? 0 : (timerUntilTime <= cTime ? 1 : timerUntilTime - cTime)};
     if (untilTime <= cTime)
     {
-        deepSleep(0);
+        deepSleep(0, timerSleepTime);
     }
     else
     {
-        deepSleep(untilTime - cTime);
+        deepSleep(untilTime - cTime, timerSleepTime);
     }
 }
 
@@ -133,9 +158,7 @@ void MIRRAModule::lightSleep(float sleepTime)
         Log::error("Sleep time was zero or negative! Skipping to avert crisis.");
         return;
     }
-    esp_sleep_disable_wakeup_source(ESP_SLEEP_WAKEUP_ALL);
-    esp_sleep_enable_timer_wakeup((uint64_t)sleepTime * 1000 * 1000);
-    esp_light_sleep_start();
+    lora.idle(static_cast<uint32_t>(sleepTime * 1000));
 }
 
 void MIRRAModule::lightSleepUntil(uint32_t untilTime)
@@ -5,11 +5,14 @@
 #include "CommunicationCommon.h"
 #include "LoRaModule.h"
 #include "PCF2129_RTC.h"
+#include "PhaseTiming.h"
+#include "Trace.h"
 #include "logging.h"
 #include <Arduino.h>
 #include <LittleFS.h>
 
-#define LOG_LEVEL Log::INFO
+#define LOG_LEVEL Log::INFO // runtime log level, messages below LOG_MIN_LEVEL (see platformio.ini) are already removed at compile time
+#define DEEP_SLEEP_RTC_THRESHOLD 30 // s, deep sleeps longer than this are woken by the external RTC's alarm, shorter ones by the internal timer
 
 /// @brief A base class for MIRRA modules to inherit from, which implements common functionality.
 class MIRRAModule
@@ -36,7 +39,7 @@ public:
     static void prepare(const MIRRAPins& pins);
 
 protected:
-    /// @brief Initialises the MIRRAModule, RTC, LoRa and logging modules.
+    /// @brief Initialises the MIRRAModule, RTC and logging modules. The LoRa module and the logfile come up on first use.
     /// @param pins The pin configuration for the MIRRAModule.
     MIRRAModule(const MIRRAPins& pins);
     /// @brief Stores the given sensor data message into the module's flash filesystem. The first type byte of the message is replaced with an 'upload' flag, at
@@ -48,14 +51,22 @@ protected:
     /// @param dataFile The file object to be pruned, opened in a read mode at the start of the file.
     /// @param maxSize The max file size in bytes.
     void pruneSensorData(File&& dataFile, uint32_t maxSize);
+    /// @brief Constructs a sensor data message holding the phase timing statistics of this module since the last such message, and resets them.
+    /// @param dest Destination MAC address of the message.
+    /// @param sequence Sequence number of the message.
+    /// @param time Timestamp of the message (UNIX epoch, seconds).
+    /// @see PhaseTiming::emit
+    Message<SENSOR_DATA> phaseTimingMessage(const MACAddress& dest, uint16_t sequence, uint32_t time);
 
     /// @brief Enters deep sleep for the specified time.
     /// @param sleepTime The time in seconds to sleep.
-    void deepSleep(uint32_t sleepTime);
+    /// @param timerSleepTime If not 0, the internal timer additionally wakes the module after this time in seconds, e.g. for the wake stub.
+    void deepSleep(uint32_t sleepTime, uint32_t timerSleepTime = 0);
     /// @brief Enters deep sleep until the specified time.
     /// @param untilTime The time (UNIX epoch, seconds) the module should wake.
-    void deepSleepUntil(uint32_t untilTime);
-    /// @brief Enters light sleep for the specified time.
+    /// @param timerUntilTime If not 0, the internal timer additionally wakes the module at this time (UNIX epoch, seconds), e.g. for the wake stub.
+    void deepSleepUntil(uint32_t untilTime, uint32_t timerUntilTime = 0);
+    /// @brief Enters light sleep for the specified time, or blocks the calling task if light sleep is disabled on the LoRa module.
     /// @param sleepTime The time in seconds to sleep.
     void lightSleep(float sleepTime);
     /// @brief Enters light sleep until the specified time.
@@ -74,6 +85,8 @@ protected:
     LoRaModule lora;
 
     CommandEntry commandEntry;
+    /// @brief Set when this wake only sampled sensors, so that it is also timed as PHASE_SAMPLE_WAKE.
+    bool sampleOnlyWake{false};
 };
 
 #endif
@@ -0,0 +1,190 @@
+#include "MQTTUplink.h"
+
+bool MQTTUplink::writeHeader(uint8_t type, size_t remainingLength)
+{
+    uint8_t header[5]{type};
+    size_t length{1};
+    do
+    {
+        uint8_t digit = remainingLength % 128;
+        remainingLength /= 128;
+        if (remainingLength > 0)
+            digit |= 0x80;
+        header[length++] = digit;
+    } while (remainingLength > 0 && length < sizeof(header));
+    lastOutbound = millis();
+    return client.write(header, length) == length;
+}
+
+bool MQTTUplink::writeString(const char* string)
+{
+    uint16_t length = strlen(string);
+    uint8_t prefix[2]{static_cast<uint8_t>(length >> 8), static_cast<uint8_t>(length & 0xFF)};
+    return client.write(prefix, sizeof(prefix)) == sizeof(prefix) && client.write(reinterpret_cast<const uint8_t*>(string), length) == length;
+}
+
+int MQTTUplink::readByte()
+{
+    uint32_t start{millis()};
+    while (!client.available())
+    {
+        if (millis() - start > MQTT_PACKET_TIMEOUT || !client.connected())
+            return -1;
+        delay(1);
+    }
+    return client.read();
+}
+
+bool MQTTUplink::connect(const char* clientID)
+{
+    window.fill(0);
+    inFlight = 0;
+    if (!client.connect(server, port))
+        return false;
+    constexpr uint8_t variableHeader[]{0x00, 0x04, 'M', 'Q', 'T', 'T', 0x04 /* 3.1.1 */, 0x02 /* clean session */, MQTT_KEEP_ALIVE >> 8, MQTT_KEEP_ALIVE & 0xFF};
+    if (!writeHeader(CONNECT, sizeof(variableHeader) + 2 + strlen(clientID)) || client.write(variableHeader, sizeof(variableHeader)) != sizeof(variableHeader) ||
+        !writeString(clientID))
+    {
+        client.stop();
+        return false;
+    }
+    int type{readByte()}, length{readByte()}, flags{readByte()}, code{readByte()};
+    if (type != CONNACK || length != 2 || flags < 0 || code != 0)
+    {
+        client.stop();
+        return false;
+    }
+    return true;
+}
+
+void MQTTUplink::disconnect()
+{
+    if (client.connected())
+    {
+        writeHeader(DISCONNECT, 0);
+        client.flush();
+    }
+    abort();
+}
+
+void MQTTUplink::abort()
+{
+    client.stop();
+    window.fill(0);
+    inFlight = 0;
+}
+
+uint16_t MQTTUplink::publish(const char* topic, const uint8_t* payload, size_t length)
+{
+    while (inFlight >= window.size())
+    {
+        if (!loop())
+            return 0;
+        delay(1);
+    }
+    if (++lastPacketId == 0)
+        lastPacketId = 1;
+    uint16_t packetId{lastPacketId};
+    uint8_t packetIdBytes[2]{static_cast<uint8_t>(packetId >> 8), static_cast<uint8_t>(packetId & 0xFF)};
+    if (!writeHeader(PUBLISH | 0x02 /* QoS1 */, 2 + strlen(topic) + sizeof(packetIdBytes) + length) || !writeString(topic) ||
+        client.write(packetIdBytes, sizeof(packetIdBytes)) != sizeof(packetIdBytes) || client.write(payload, length) != length)
+    {
+        // the stream is left with a partial packet, after which nothing on it can be parsed by the server
+        abort();
+        return 0;
+    }
+    for (uint16_t& slot : window)
+    {
+        if (slot == 0)
+        {
+            slot = packetId;
+            break;
+        }
+    }
+    inFlight++;
+    return packetId;
+}
+
+uint8_t MQTTUplink::readPacket()
+{
+    int type{readByte()};
+    if (type < 0)
+    {
+        abort();
+        return 0;
+    }
+    size_t remainingLength{0};
+    for (size_t multiplier{1};; multiplier *= 128)
+    {
+        int digit{readByte()};
+        if (digit < 0)
+        {
+            abort();
+            return 0;
+        }
+        remainingLength += (digit & 0x7F) * multiplier;
+        if (!(digit & 0x80))
+            break;
+    }
+    if ((type & 0xF0) == PUBACK && remainingLength == 2)
+    {
+        int msb{readByte()}, lsb{readByte()};
+        if (msb < 0 || lsb < 0)
+        {
+            abort();
+            return 0;
+        }
+        uint16_t packetId = (msb << 8) | lsb;
+        for (uint16_t& slot : window)
+        {
+            if (slot == packetId)
+            {
+                slot = 0;
+                inFlight--;
+                if (ackCallback)
+                    ackCallback(packetId);
+                break;
+            }
+        }
+        return PUBACK;
+    }
+    // packets of no interest to a publish-only client are skipped
+    for (; remainingLength > 0; remainingLength--)
+    {
+        if (readByte() < 0)
+        {
+            abort();
+            return 0;
+        }
+    }
+    return type & 0xF0;
+}
+
+bool MQTTUplink::loop()
+{
+    if (!client.connected())
+        return false;
+    while (client.available())
+    {
+        if (readPacket() == 0)
+            return false;
+    }
+    if (millis() - lastOutbound > MQTT_KEEP_ALIVE * 1000 / 2 && !writeHeader(PINGREQ, 0))
+    {
+        abort();
+        return false;
+    }
+    return true;
+}
+
+bool MQTTUplink::flush(uint32_t timeoutMs)
+{
+    uint32_t start{millis()};
+    while (inFlight > 0)
+    {
+        if (millis() - start > timeoutMs || !loop())
+            return false;
+        delay(1);
+    }
+    return true;
+}
@@ -0,0 +1,99 @@
+#ifndef __MQTT_UPLINK_H__
+#define __MQTT_UPLINK_H__
+
+#include <Arduino.h>
+#include <Client.h>
+#include <IPAddress.h>
+
+#include <array>
+#include <functional>
+
+#define MQTT_WINDOW_SIZE 8     // max amount of QoS1 publishes awaiting a PUBACK at the same time
+#define MQTT_KEEP_ALIVE 60     // s, keep alive interval announced to the MQTT server
+#define MQTT_PACKET_TIMEOUT 5000 // ms, time to wait for the remainder of an incoming packet or for a CONNACK
+
+/// @brief Minimal MQTT 3.1.1 client that publishes at QoS1 and keeps a window of publishes in flight, reporting each PUBACK through a callback. Unlike
+/// PubSubClient, a publish is only considered delivered once the server has acknowledged it, without waiting a round trip for each publish.
+class MQTTUplink
+{
+public:
+    /// @brief Callback invoked when the server acknowledges a publish.
+    /// @param packetId The packet identifier returned by publish.
+    typedef std::function<void(uint16_t packetId)> AckCallback;
+
+    /// @param client Transport (e.g. WiFiClient) to use for the connection.
+    /// @param server Address of the MQTT server.
+    /// @param port Port of the MQTT server.
+    MQTTUplink(Client& client, IPAddress server, uint16_t port) : client{client}, server{server}, port{port} {}
+
+    /// @brief Opens a clean session with the MQTT server.
+    /// @param clientID Client identifier to announce to the server.
+    /// @return Whether the server accepted the connection.
+    bool connect(const char* clientID);
+    /// @return Whether the connection to the server is open.
+    bool connected() { return client.connected(); }
+    /// @brief Sends a DISCONNECT and closes the connection. Publishes still in flight are forgotten without invoking the callback.
+    void disconnect();
+
+    /// @brief Publishes a message at QoS1. If the window is full, this blocks (processing incoming acknowledgements) until a slot frees up.
+    /// @param topic Topic to publish to.
+    /// @param payload Pointer to the payload.
+    /// @param length Length of the payload in bytes.
+    /// @return The packet identifier of the publish, or 0 if it could not be sent. A partially written publish closes the connection.
+    uint16_t publish(const char* topic, const uint8_t* payload, size_t length);
+    /// @brief Processes incoming packets and sends a keep alive if required. Must be called regularly while connected.
+    /// @return Whether the connection is still open.
+    bool loop();
+    /// @brief Waits until all publishes in flight have been acknowledged.
+    /// @param timeoutMs Maximum time to wait in ms.
+    /// @return Whether all publishes were acknowledged in time.
+    bool flush(uint32_t timeoutMs);
+
+    /// @param callback Callback to invoke for each acknowledged publish.
+    void setAckCallback(AckCallback callback) { this->ackCallback = callback; }
+    /// @return The amount of publishes awaiting acknowledgement.
+    size_t getInFlight() const { return inFlight; }
+
+private:
+    enum PacketType : uint8_t
+    {
+        CONNECT = 0x10,
+        CONNACK = 0x20,
+        PUBLISH = 0x30,
+        PUBACK = 0x40,
+        PINGREQ = 0xC0,
+        PINGRESP = 0xD0,
+        DISCONNECT = 0xE0
+    };
+
+    Client& client;
+    IPAddress server;
+    uint16_t port;
+    AckCallback ackCallback{};
+
+    /// @brief Packet identifiers of the publishes in flight. A slot is free when its identifier is 0.
+    std::array<uint16_t, MQTT_WINDOW_SIZE> window{0};
+    size_t inFlight{0};
+    /// @brief Last packet identifier handed out, 0 is never used.
+    uint16_t lastPacketId{0};
+    /// @brief Time of the last packet sent (ms since boot), used to schedule keep alives.
+    uint32_t lastOutbound{0};
+
+    /// @brief Writes an MQTT fixed header.
+    /// @param type Packet type, including flags.
+    /// @param remainingLength Length of the variable header and payload.
+    /// @return Whether the header could be written.
+    bool writeHeader(uint8_t type, size_t remainingLength);
+    /// @brief Writes a length-prefixed MQTT string.
+    bool writeString(const char* string);
+    /// @brief Reads a single byte, waiting up to MQTT_PACKET_TIMEOUT for it to arrive.
+    /// @return The byte read, or -1 on timeout.
+    int readByte();
+    /// @brief Reads and handles a single incoming packet.
+    /// @return The type of the packet read, or 0 if none could be read, in which case the connection is closed.
+    uint8_t readPacket();
+    /// @brief Closes the connection without DISCONNECT, forgetting the publishes in flight. Used when the stream is left with a partial packet.
+    void abort();
+};
+
+#endif
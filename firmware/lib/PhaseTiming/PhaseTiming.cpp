@@ -0,0 +1,71 @@
+#include "PhaseTiming.h"
+#include <esp_attr.h>
+
+RTC_DATA_ATTR std::array<PhaseTiming::Stats, PHASE_COUNT> phaseStats;
+
+void PhaseTiming::record(Phase phase, int64_t startUs)
+{
+    uint32_t durationUs = esp_timer_get_time() - startUs;
+    Stats& stats{phaseStats[phase]};
+    stats.count++;
+    stats.totalUs += durationUs;
+    if (durationUs > stats.maxUs)
+        stats.maxUs = durationUs;
+    size_t bucket{0};
+    while (bucket < bounds.size() && durationUs > bounds[bucket] * 1000)
+        bucket++;
+    stats.histogram[bucket]++;
+}
+
+const PhaseTiming::Stats& PhaseTiming::getStats(Phase phase) { return phaseStats[phase]; }
+
+const char* PhaseTiming::getName(Phase phase)
+{
+    switch (phase)
+    {
+    case PHASE_BOOT:
+        return "boot";
+    case PHASE_CONSTRUCTOR:
+        return "constructor";
+    case PHASE_LITTLEFS:
+        return "littlefs";
+    case PHASE_LORA_INIT:
+        return "lora init";
+    case PHASE_SAMPLE:
+        return "sample";
+    case PHASE_RADIO_TX:
+        return "radio tx";
+    case PHASE_RADIO_RX:
+        return "radio rx";
+    case PHASE_FLASH:
+        return "flash";
+    case PHASE_COMMAND:
+        return "command";
+    case PHASE_SLEEP:
+        return "sleep";
+    case PHASE_WAKE:
+        return "wake";
+    case PHASE_TO_SAMPLE:
+        return "to sample";
+    case PHASE_SAMPLE_WAKE:
+        return "sample wake";
+    default:
+        return "none";
+    }
+}
+
+size_t PhaseTiming::emit(SensorValue* values, size_t max)
+{
+    size_t n{0};
+    for (size_t phase{0}; phase < PHASE_COUNT && n + 3 <= max; phase++)
+    {
+        Stats& stats{phaseStats[phase]};
+        if (stats.count == 0)
+            continue;
+        values[n++] = SensorValue(PHASE_TIMING_TYPE + phase, 0, static_cast<float>(stats.totalUs) / stats.count / 1000);
+        values[n++] = SensorValue(PHASE_TIMING_TYPE + phase, 1, static_cast<float>(stats.maxUs) / 1000);
+        values[n++] = SensorValue(PHASE_TIMING_TYPE + phase, 2, static_cast<float>(stats.count));
+        stats = Stats{};
+    }
+    return n;
+}
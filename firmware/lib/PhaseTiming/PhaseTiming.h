@@ -0,0 +1,75 @@
+#ifndef __PHASE_TIMING_H__
+#define __PHASE_TIMING_H__
+
+#include <Sensor.h>
+#include <array>
+#include <esp_timer.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define PHASE_TIMING_TYPE 0xF00 // sensor type IDs from 0xF00 onwards are reserved for phase timing telemetry, one per phase
+
+/// @brief Phases of a wake that are timed.
+enum Phase : uint8_t
+{
+    PHASE_BOOT,        // from reset until MIRRAModule::prepare
+    PHASE_CONSTRUCTOR, // module constructor
+    PHASE_LITTLEFS,    // LittleFS mount
+    PHASE_LORA_INIT,   // LoRa module init
+    PHASE_SAMPLE,      // sensor sampling
+    PHASE_RADIO_TX,    // LoRa packet transmission
+    PHASE_RADIO_RX,    // awaiting and receiving a LoRa message
+    PHASE_FLASH,       // sensor data file I/O
+    PHASE_COMMAND,     // command prompt
+    PHASE_SLEEP,       // deep sleep entry
+    PHASE_WAKE,        // whole wake, from reset until deep sleep
+    PHASE_TO_SAMPLE,   // from reset until the sensors are started
+    PHASE_SAMPLE_WAKE, // whole wake, from reset until deep sleep, of wakes that only sampled
+    PHASE_COUNT
+};
+
+/// @brief Accumulates the time spent in each phase of a wake in RTC memory, as counters and histograms, and emits them as telemetry sensor values. Only to
+/// be used from the main task.
+class PhaseTiming
+{
+public:
+    /// @brief Upper bounds (ms) of the histogram buckets. The last bucket holds all durations above the last bound.
+    static constexpr std::array<uint32_t, 7> bounds{1, 4, 16, 64, 256, 1024, 4096};
+    struct Stats
+    {
+        uint32_t count{0};
+        uint64_t totalUs{0};
+        uint32_t maxUs{0};
+        std::array<uint32_t, bounds.size() + 1> histogram{0};
+    };
+
+    /// @brief Times a phase for the lifetime of the object.
+    class Scope
+    {
+        Phase phase;
+        int64_t start;
+
+    public:
+        Scope(Phase phase) : phase{phase}, start{esp_timer_get_time()} {}
+        ~Scope() { record(phase, start); }
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+    };
+
+    /// @brief Records the duration of a phase that ends now.
+    /// @param phase The phase.
+    /// @param startUs Start of the phase (esp_timer_get_time), 0 for phases that start at reset.
+    static void record(Phase phase, int64_t startUs);
+    /// @return The statistics of a phase since the last emit.
+    static const Stats& getStats(Phase phase);
+    /// @return The name of a phase.
+    static const char* getName(Phase phase);
+    /// @brief Writes the mean and max duration (ms) and count of each phase since the last emit as sensor values and resets the statistics. The values are
+    /// tagged with type PHASE_TIMING_TYPE + phase and instance 0 (mean), 1 (max) and 2 (count).
+    /// @param values Array to write the values to.
+    /// @param max Maximum amount of values to write.
+    /// @return The amount of values written.
+    static size_t emit(SensorValue* values, size_t max);
+};
+
+#endif
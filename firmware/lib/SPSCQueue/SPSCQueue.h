@@ -0,0 +1,54 @@
+#ifndef __SPSC_QUEUE_H__
+#define __SPSC_QUEUE_H__
+
+#include <array>
+#include <atomic>
+#include <stddef.h>
+
+/// @brief Lock-free, fixed-capacity queue for exactly one producer task and one consumer task, which may run on different cores.
+/// @tparam T Type of the queued items. Should be cheap to copy.
+/// @tparam N Capacity of the queue. Must be a power of two.
+template <class T, size_t N> class SPSCQueue
+{
+    static_assert(N > 0 && (N & (N - 1)) == 0, "SPSCQueue capacity must be a power of two.");
+
+private:
+    std::array<T, N> buffer{};
+    /// @brief Amount of items ever pushed. Only written by the producer.
+    std::atomic<size_t> head{0};
+    /// @brief Amount of items ever popped. Only written by the consumer.
+    std::atomic<size_t> tail{0};
+
+public:
+    /// @brief Appends an item to the queue. May only be called by the producer.
+    /// @return False if the queue is full, in which case the item is not queued.
+    bool push(const T& item)
+    {
+        size_t h{head.load(std::memory_order_relaxed)};
+        if (h - tail.load(std::memory_order_acquire) == N)
+            return false;
+        buffer[h % N] = item;
+        head.store(h + 1, std::memory_order_release);
+        return true;
+    }
+    /// @brief Takes the oldest item from the queue. May only be called by the consumer.
+    /// @param item Reference to which the item is written.
+    /// @return False if the queue is empty.
+    bool pop(T& item)
+    {
+        size_t t{tail.load(std::memory_order_relaxed)};
+        if (t == head.load(std::memory_order_acquire))
+            return false;
+        item = buffer[t % N];
+        tail.store(t + 1, std::memory_order_release);
+        return true;
+    }
+    /// @return Whether the queue is empty. Only a snapshot when called from the producer.
+    bool empty() const { return head.load(std::memory_order_acquire) == tail.load(std::memory_order_acquire); }
+    /// @return The amount of items in the queue. Only a snapshot when called concurrently with push or pop.
+    size_t size() const { return head.load(std::memory_order_acquire) - tail.load(std::memory_order_acquire); }
+    /// @return The capacity of the queue.
+    static constexpr size_t capacity() { return N; }
+};
+
+#endif
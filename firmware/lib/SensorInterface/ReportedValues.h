@@ -0,0 +1,94 @@
+#ifndef __REPORTED_VALUES_H__
+#define __REPORTED_VALUES_H__
+
+#include "Sensor.h"
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define DEAD_BAND_MAX_VALUES 32 // last reported values kept for the dead-banded sensors of a node, by the node and by the gateway alike
+
+/// @brief Last reported value of each sensor value tag, for report-by-exception (dead-band) sampling. Kept in RTC memory by the node to decide which values
+/// to store, and per node by the gateway to fill in the values the node left out. When full, the least recently reported tag is replaced, after which its
+/// next value is reported again.
+/// @tparam size Maximum amount of tags.
+template <size_t size> class ReportedValues
+{
+public:
+    struct Entry
+    {
+        uint16_t tag{0};
+        /// @brief Sequence number of the record holding the report, only kept by the gateway.
+        uint16_t sequence{0};
+        float value{0};
+        /// @brief Time of the report (UNIX epoch, seconds).
+        uint32_t time{0};
+    };
+
+private:
+    uint8_t nEntries{0};
+    Entry entries[size]{};
+
+public:
+    /// @return The last report of a tag, nullptr if there is none.
+    Entry* find(uint16_t tag)
+    {
+        for (size_t i{0}; i < nEntries; i++)
+        {
+            if (entries[i].tag == tag)
+                return &entries[i];
+        }
+        return nullptr;
+    }
+    /// @brief Sets the last reported value of a tag.
+    void set(const SensorValue& value, uint32_t time, uint16_t sequence = 0)
+    {
+        Entry* entry{find(value.tag)};
+        if (!entry && nEntries < size)
+        {
+            entry = &entries[nEntries++];
+        }
+        else if (!entry)
+        {
+            entry = &entries[0];
+            for (size_t i{1}; i < nEntries; i++)
+            {
+                if (entries[i].time < entry->time)
+                    entry = &entries[i];
+            }
+        }
+        *entry = Entry{value.tag, sequence, value.value, time};
+    }
+    /// @brief Decides whether a value is reported, and if so, keeps it as the last reported value of its tag. A value is reported if it differs more than
+    /// the dead-band from the last reported value, if the maximum silence has passed since, or if there is no last reported value. Non-finite values
+    /// (failed measurements) are always reported.
+    /// @param value The value.
+    /// @param time Time of the value.
+    /// @param deadBand Maximum difference from the last reported value for which the value is left out.
+    /// @param maxSilence Time (s) since the last report after which the value is reported regardless.
+    /// @return Whether the value is reported.
+    bool report(const SensorValue& value, uint32_t time, float deadBand, uint32_t maxSilence)
+    {
+        const Entry* last{find(value.tag)};
+        if (last && isfinite(value.value) && isfinite(last->value) && fabsf(value.value - last->value) <= deadBand && time - last->time < maxSilence)
+            return false;
+        set(value, time);
+        return true;
+    }
+    /// @brief Forgets the reported values of all tags of a sensor.
+    /// @param typeTag Type ID of the sensor.
+    void clearType(unsigned int typeTag)
+    {
+        uint8_t kept{0};
+        for (size_t i{0}; i < nEntries; i++)
+        {
+            if ((entries[i].tag >> 4) != (typeTag & 0xFFF))
+                entries[kept++] = entries[i];
+        }
+        nEntries = kept;
+    }
+    /// @brief Forgets all reported values.
+    void clear() { nEntries = 0; }
+};
+
+#endif
@@ -1,9 +1,12 @@
 #ifndef SENSOR_H
 #define SENSOR_H
 
+#include <stddef.h>
 #include <stdint.h>
 #include <time.h>
 
+#define SENSOR_MAX_VALUES 16 // values of a single measurement, as distinguished by the 4 bit instance tag
+
 struct SensorValue
 {
     uint16_t tag{0};
@@ -18,11 +21,10 @@ struct SensorValue
     SensorValue(uint16_t tag, float value) : tag{tag}, value{value} {};
 } __attribute__((packed));
 
-// TODO: Find a way to avoid virtual functions, possibly using CRTP? -> Will make iterating over polymorphic container difficult
-
 /**
  * Sensor interface, this interface has to be overriden by all the sensor classes. This class allows to
- * have a generic way of reading the sensors.
+ * have a generic way of reading the sensors. Sensor classes should be final: held in a SensorSet, they are
+ * called through their concrete type, which avoids virtual dispatch.
  */
 class Sensor
 {
@@ -31,10 +33,34 @@ public:
     virtual void setup() {}
     /// @brief Starts the measurement of the sensor.
     virtual void startMeasurement() {}
+    /// @return The time in milliseconds from startMeasurement until getMeasurement returns without waiting for the conversion. Sensors of which
+    /// startMeasurement or getMeasurement blocks for the whole conversion report 0.
+    virtual uint32_t getConversionTime() const { return 0; }
     // @return The measured value.
     virtual SensorValue getMeasurement() = 0;
+    /// @brief Gets all values of the measurement, for sensors that measure several values at once (e.g. several probes), each under its own instance tag.
+    /// Only called instead of getMeasurement.
+    /// @param values Array to write the values to.
+    /// @param max Maximum amount of values to write, at most SENSOR_MAX_VALUES.
+    /// @return The amount of values written.
+    virtual size_t getMeasurements(SensorValue* values, size_t max)
+    {
+        if (max == 0)
+            return 0;
+        values[0] = getMeasurement();
+        return 1;
+    }
     /// @return The sensor's type ID.
     virtual uint8_t getID() const = 0;
+    /// @return The ADC pin of the sensor if its measurement is a single ADC1 conversion, which the deep sleep wake stub can take without booting the firmware.
+    /// -1 otherwise.
+    virtual int8_t getStubPin() const { return -1; }
+    /// @return The pin to drive high during a conversion taken by the wake stub, -1 for none.
+    virtual int8_t getStubEnablePin() const { return -1; }
+    /// @brief Converts a conversion taken by the wake stub into the sensor's value.
+    /// @param raw Raw ADC value.
+    /// @param milliVolts Calibrated voltage in mV.
+    virtual SensorValue fromStubSample(uint16_t raw, uint32_t /*milliVolts*/) { return SensorValue(getID(), 0, static_cast<float>(raw)); }
     /// @brief Updates the sensor's next sample time according to the sensor-specific algorithm. (usually simply addition)
     /// @param sampleInterval Sample interval with which to update.
     virtual void updateNextSampleTime(uint32_t sampleInterval) { this->nextSampleTime += sampleInterval; };
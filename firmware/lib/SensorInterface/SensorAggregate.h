@@ -0,0 +1,71 @@
+#ifndef __SENSOR_AGGREGATE_H__
+#define __SENSOR_AGGREGATE_H__
+
+#include "Sensor.h"
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/// @brief Running statistics of the readings of a sensor over an aggregation interval, updated per reading (Welford's algorithm) so that only this struct
+/// has to be kept in RTC memory between readings. Non-finite readings (failed measurements) are left out.
+struct SensorAggregate
+{
+    /// @brief Statistics emitted for an interval, in order of their instance tags.
+    enum Statistic : uint8_t
+    {
+        MEAN,   // instance 0, so that the mean continues the series of the sensor's plain readings
+        MIN,    // instance 1
+        MAX,    // instance 2
+        STDDEV, // instance 3, population standard deviation
+        COUNT,  // instance 4, amount of readings
+        STATISTIC_COUNT
+    };
+
+    uint16_t count{0};
+    float min{0};
+    float max{0};
+    float mean{0};
+    /// @brief Sum of squared differences from the mean.
+    float m2{0};
+
+    /// @brief Adds a reading.
+    void add(float value)
+    {
+        if (!isfinite(value))
+            return;
+        if (count == 0)
+        {
+            min = value;
+            max = value;
+        }
+        else
+        {
+            min = fminf(min, value);
+            max = fmaxf(max, value);
+        }
+        count++;
+        float delta{value - mean};
+        mean += delta / count;
+        m2 += delta * (value - mean);
+    }
+    /// @brief Writes the statistics as sensor values, tagged with the sensor's type and the statistic as instance. Nothing is written if there were no
+    /// readings.
+    /// @param typeTag Type ID of the sensor.
+    /// @param values Array to write the values to.
+    /// @param max Maximum amount of values to write.
+    /// @return The amount of values written.
+    size_t emit(unsigned int typeTag, SensorValue* values, size_t max) const
+    {
+        if (count == 0)
+            return 0;
+        const float statistics[STATISTIC_COUNT]{mean, this->min, this->max, sqrtf(m2 / count), static_cast<float>(count)};
+        size_t n{0};
+        for (; n < STATISTIC_COUNT && n < max; n++)
+            values[n] = SensorValue(typeTag, n, statistics[n]);
+        return n;
+    }
+    /// @brief Clears the statistics for the next interval.
+    void reset() { *this = SensorAggregate{}; }
+};
+
+#endif
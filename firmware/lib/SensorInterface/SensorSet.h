@@ -0,0 +1,69 @@
+#ifndef __SENSOR_SET_H__
+#define __SENSOR_SET_H__
+
+#include "Sensor.h"
+#include <new>
+#include <stddef.h>
+#include <stdint.h>
+#include <tuple>
+#include <utility>
+
+/// @brief Fixed set of concrete sensors, held in place without any heap allocation. The sensors are constructed and destroyed as a whole, and are iterated
+/// over with their concrete (final) types, so calls on them are resolved at compile time instead of through the Sensor vtable.
+/// @tparam Sensors Concrete sensor types, each derived from Sensor and appearing at most once.
+template <typename... Sensors> class SensorSet
+{
+private:
+    /// @brief Uninitialised storage for a single sensor.
+    template <typename T> struct Slot
+    {
+        alignas(T) uint8_t storage[sizeof(T)];
+        T& get() { return *std::launder(reinterpret_cast<T*>(storage)); }
+    };
+
+    std::tuple<Slot<Sensors>...> slots;
+    bool constructed{false};
+
+    template <typename T, typename Args> void construct(Args&& args)
+    {
+        std::apply([this](auto&&... a) { new (std::get<Slot<T>>(slots).storage) T(std::forward<decltype(a)>(a)...); }, std::forward<Args>(args));
+    }
+    template <typename F, size_t... I> void forEach(F& f, std::index_sequence<I...>) { (f(std::get<I>(slots).get(), I), ...); }
+
+public:
+    /// @brief The amount of sensors in the set.
+    static constexpr size_t size{sizeof...(Sensors)};
+
+    SensorSet() = default;
+    SensorSet(const SensorSet&) = delete;
+    SensorSet& operator=(const SensorSet&) = delete;
+    ~SensorSet() { clear(); }
+
+    /// @brief Constructs all sensors in place, in order, destroying any previously constructed ones first. A sensor may take a reference to an earlier
+    /// sensor in the set, obtained through get.
+    /// @param args One tuple of constructor arguments per sensor, in the order of the set, e.g. made with std::forward_as_tuple.
+    template <typename... Args> void emplace(Args&&... args)
+    {
+        static_assert(sizeof...(Args) == size, "One tuple of constructor arguments is needed per sensor.");
+        clear();
+        (construct<Sensors>(std::forward<Args>(args)), ...);
+        constructed = true;
+    }
+    /// @brief Destroys all sensors.
+    void clear()
+    {
+        if (!constructed)
+            return;
+        (std::get<Slot<Sensors>>(slots).get().~Sensors(), ...);
+        constructed = false;
+    }
+    /// @return Whether the sensors are constructed.
+    bool isConstructed() const { return constructed; }
+
+    /// @return The sensor of the given type. The reference is valid, but may only be used after emplace.
+    template <typename T> T& get() { return std::get<Slot<T>>(slots).get(); }
+    /// @brief Calls a function on each sensor in order, as f(sensor, index), with the sensor's concrete type.
+    template <typename F> void forEach(F&& f) { forEach(f, std::index_sequence_for<Sensors...>{}); }
+};
+
+#endif
@@ -8,7 +8,11 @@ void BatterySensor::setup()
 void BatterySensor::startMeasurement() { digitalWrite(enablePin, HIGH); }
 SensorValue BatterySensor::getMeasurement()
 {
-    SensorValue value{getID(), 2 * static_cast<float>(analogReadMilliVolts(pin)) / 1000}; // times two because of voltage divider (see schematic)
+    SensorValue value{fromStubSample(0, analogReadMilliVolts(pin))};
     digitalWrite(enablePin, LOW);
     return value;
+}
+SensorValue BatterySensor::fromStubSample(uint16_t raw, uint32_t milliVolts)
+{
+    return SensorValue(getID(), 0, 2 * static_cast<float>(milliVolts) / 1000); // times two because of voltage divider (see schematic)
 }
\ No newline at end of file
@@ -17,5 +17,8 @@ public:
     void startMeasurement();
     SensorValue getMeasurement();
     uint8_t getID() const { return BATTERY_KEY; };
+    int8_t getStubPin() const { return pin; }
+    int8_t getStubEnablePin() const { return enablePin; }
+    SensorValue fromStubSample(uint16_t raw, uint32_t milliVolts);
 };
 #endif
\ No newline at end of file
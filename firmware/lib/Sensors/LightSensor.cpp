@@ -10,5 +10,5 @@ SensorValue LightSensor::getMeasurement()
 {
     while (!baseSensor.isMeasurementReady())
         ;
-    return SensorValue(getID(), static_cast<float>(baseSensor.getLuminosityMeasurement().raw));
+    return SensorValue(getID(), 0, static_cast<float>(baseSensor.getLuminosityMeasurement().raw));
 }
\ No newline at end of file
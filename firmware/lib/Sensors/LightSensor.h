@@ -6,6 +6,7 @@
 #include <AsyncAPDS9306.h>
 
 #define LIGHT_KEY 22
+#define LIGHT_CONVERSION_TIME 30 // ms, integration time of APDS9306_ALS_MEAS_RES_16BIT_25MS with margin for the oscillator tolerance
 
 class LightSensor final : public Sensor
 {
@@ -16,6 +17,7 @@ public:
     LightSensor() = default;
     void startMeasurement();
     SensorValue getMeasurement();
+    uint32_t getConversionTime() const { return LIGHT_CONVERSION_TIME; }
     uint8_t getID() const { return LIGHT_KEY; };
 };
 #endif
\ No newline at end of file
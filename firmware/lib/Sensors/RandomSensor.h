@@ -11,7 +11,7 @@ private:
 
 public:
     RandomSensor(uint32_t seed) { srand(seed); }
-    SensorValue getMeasurement() { return SensorValue(getID(), static_cast<float>(rand() % 101)); };
+    SensorValue getMeasurement() { return SensorValue(getID(), 0, static_cast<float>(rand() % 101)); };
     uint8_t getID() const { return RANDOM_KEY; }
 };
 #endif
\ No newline at end of file
@@ -14,8 +14,9 @@ private:
 public:
     SoilMoistureSensor(uint8_t pin) : pin{pin} {};
     void startMeasurement() { pinMode(pin, INPUT); };
-    SensorValue getMeasurement() { return SensorValue(getID(), static_cast<float>(analogRead(pin))); };
+    SensorValue getMeasurement() { return SensorValue(getID(), 0, static_cast<float>(analogRead(pin))); };
     uint8_t getID() const { return SOIL_MOISTURE_KEY; };
+    int8_t getStubPin() const { return pin; }
 };
 
 #endif
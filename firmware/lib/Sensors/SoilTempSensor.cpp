@@ -1,13 +1,90 @@
 #include "SoilTempSensor.h"
+#include <Arduino.h>
 #include <DallasTemperature.h>
+#include <logging.h>
 
-void SoilTemperatureSensor::startMeasurement() { dallas.begin(); }
+#define DS18B20_CONVERT_T 0x44
+
+/// @brief ROM addresses of the probes, indexed by their instance tag. An unused instance has an all-zero address.
+RTC_DATA_ATTR DeviceAddress soilTemperatureProbes[SOIL_TEMPERATURE_MAX_PROBES];
+/// @brief Amount of instance tags assigned to probes, including those of probes that have gone missing.
+RTC_DATA_ATTR uint8_t nSoilTemperatureProbes{0};
+/// @brief Bit i is set if the probe of instance i was found by the last search of the bus.
+RTC_DATA_ATTR uint8_t soilTemperatureProbesPresent{0};
+static_assert(SOIL_TEMPERATURE_MAX_PROBES <= 8, "soilTemperatureProbesPresent holds a bit per probe.");
+/// @brief Resolution the probes were configured with, 0 if the bus has to be searched again.
+RTC_DATA_ATTR uint8_t soilTemperatureResolution{0};
+
+void SoilTemperatureSensor::enumerate()
+{
+    soilTemperatureProbesPresent = 0;
+    DeviceAddress address;
+    wire.reset_search();
+    while (wire.search(address))
+    {
+        if (OneWire::crc8(address, 7) != address[7] || !dallas.validFamily(address))
+            continue;
+        uint8_t instance{0};
+        while (instance < nSoilTemperatureProbes && memcmp(soilTemperatureProbes[instance], address, sizeof(DeviceAddress)) != 0)
+            instance++;
+        if (instance == nSoilTemperatureProbes)
+        {
+            if (nSoilTemperatureProbes >= SOIL_TEMPERATURE_MAX_PROBES)
+            {
+                Log::error("No instance tag left for a new soil temperature probe, ignoring it.");
+                continue;
+            }
+            memcpy(soilTemperatureProbes[nSoilTemperatureProbes++], address, sizeof(DeviceAddress));
+        }
+        soilTemperatureProbesPresent |= 1 << instance;
+        // the resolution is kept in the probe's EEPROM, so that it survives the peripherals being powered down during deep sleep, and is only written when it
+        // differs to spare the EEPROM's write cycles
+        if (dallas.getResolution(address) != resolution)
+            dallas.setResolution(address, resolution, true);
+    }
+    uint8_t nPresent{0};
+    for (uint8_t i{0}; i < nSoilTemperatureProbes; i++)
+        nPresent += (soilTemperatureProbesPresent >> i) & 1;
+    Log::info("Found ", nPresent, " of ", nSoilTemperatureProbes, " soil temperature probes.");
+    soilTemperatureResolution = nPresent > 0 ? resolution : 0;
+}
+
+void SoilTemperatureSensor::startMeasurement()
+{
+    if (soilTemperatureResolution != resolution)
+        enumerate();
+    // one broadcast conversion for all probes, the results are read in getMeasurements once the conversion time has passed
+    wire.reset();
+    wire.skip();
+    wire.write(DS18B20_CONVERT_T);
+    conversionTime = soilTemperatureProbesPresent != 0 ? dallas.millisToWaitForConversion(resolution) : 0;
+}
 
 SensorValue SoilTemperatureSensor::getMeasurement()
 {
+    SensorValue value{getID(), 0, NAN};
+    getMeasurements(&value, 1);
+    return value;
+}
 
-    DeviceAddress longWireThermometer;
-    dallas.getAddress(longWireThermometer, 0);
-    dallas.requestTemperaturesByAddress(longWireThermometer);
-    return SensorValue(getID(), dallas.getTempCByIndex(this->busIndex));
-}
\ No newline at end of file
+size_t SoilTemperatureSensor::getMeasurements(SensorValue* values, size_t max)
+{
+    size_t nValues{0};
+    for (; nValues < nSoilTemperatureProbes && nValues < max; nValues++)
+    {
+        if (!((soilTemperatureProbesPresent >> nValues) & 1))
+        {
+            values[nValues] = SensorValue(getID(), nValues, NAN);
+            continue;
+        }
+        float temperature{dallas.getTempC(soilTemperatureProbes[nValues])};
+        if (temperature == DEVICE_DISCONNECTED_C)
+        {
+            Log::error("Soil temperature probe ", nValues, " did not respond, searching the bus again on the next measurement.");
+            temperature = NAN;
+            soilTemperatureResolution = 0;
+        }
+        values[nValues] = SensorValue(getID(), nValues, temperature);
+    }
+    return nValues;
+}
@@ -6,21 +6,32 @@
 
 #include "Sensor.h"
 
-#define SOIL_TEMPERATURE_KEY 4;
+#define SOIL_TEMPERATURE_KEY 4
+#define SOIL_TEMPERATURE_MAX_PROBES 8 // probes on the bus, each reported under its own instance tag
+
+/// @brief DS18B20 probes on a single 1-Wire bus, e.g. a soil temperature profile. The bus is searched once, after which the ROM addresses of the probes are
+/// kept in RTC memory. A measurement starts the conversion of all probes at once with a single broadcast CONVERT T, after which each probe is read by address.
+/// Each probe is reported under the instance tag it was first found under (in ROM address order on the first search), which it keeps when the bus is
+/// searched again. A probe that has gone missing is reported as NaN under its instance tag, so that the other probes' series are not shifted.
 class SoilTemperatureSensor final : public Sensor
 {
 private:
-    /// @brief Pin number of 1W interface.
-    uint8_t pin;
-    /// @brief The bus index of the sensor.
-    uint8_t busIndex;
     OneWire wire;
     DallasTemperature dallas;
+    /// @brief Resolution in bits (9 to 12). The conversion time doubles with every bit, from 94 ms at 9 bits to 750 ms at 12 bits.
+    uint8_t resolution;
+    /// @brief Conversion time in milliseconds at the resolution, 0 if there are no probes on the bus. Determined when the measurement is started.
+    uint32_t conversionTime{0};
+
+    /// @brief Searches the bus for probes, assigns new probes an instance tag and configures their resolution.
+    void enumerate();
 
 public:
-    SoilTemperatureSensor(uint8_t pin, uint8_t busIndex) : pin{pin}, busIndex{busIndex}, wire{OneWire(pin)}, dallas{&wire} {}
+    SoilTemperatureSensor(uint8_t pin, uint8_t resolution) : wire{OneWire(pin)}, dallas{&wire}, resolution{resolution} {}
     void startMeasurement();
+    uint32_t getConversionTime() const { return conversionTime; }
     SensorValue getMeasurement();
+    size_t getMeasurements(SensorValue* values, size_t max);
     uint8_t getID() const { return SOIL_TEMPERATURE_KEY; };
 };
 
@@ -11,6 +11,6 @@ void TempSHTSensor::setup(void)
 }
 void TempSHTSensor::startMeasurement() { baseSensor.readSample(); }
 
-SensorValue TempSHTSensor::getMeasurement() { return SensorValue(getID(), baseSensor.getTemperature()); }
+SensorValue TempSHTSensor::getMeasurement() { return SensorValue(getID(), 0, baseSensor.getTemperature()); }
 
-SensorValue HumiSHTSensor::getMeasurement() { return SensorValue(getID(), baseSensor.getHumidity()); }
+SensorValue HumiSHTSensor::getMeasurement() { return SensorValue(getID(), 0, baseSensor.getHumidity()); }
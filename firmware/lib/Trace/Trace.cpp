@@ -0,0 +1,17 @@
+#include "Trace.h"
+
+std::array<TraceRecord, TRACE_BUFFER_SIZE> Trace::buffer;
+std::atomic<uint32_t> Trace::head{0};
+
+void Trace::dump(Print& out)
+{
+    uint32_t end{head.load(std::memory_order_relaxed)};
+    uint32_t count{std::min<uint32_t>(end, TRACE_BUFFER_SIZE)};
+    uint32_t overwritten{end - count};
+    out.write(reinterpret_cast<const uint8_t*>(magic), sizeof(magic));
+    out.write(reinterpret_cast<const uint8_t*>(&count), sizeof(count));
+    out.write(reinterpret_cast<const uint8_t*>(&overwritten), sizeof(overwritten));
+    for (uint32_t i{end - count}; i != end; i++)
+        out.write(reinterpret_cast<const uint8_t*>(&buffer[i % TRACE_BUFFER_SIZE]), sizeof(TraceRecord));
+    out.flush();
+}
@@ -0,0 +1,73 @@
+#ifndef __TRACE_H__
+#define __TRACE_H__
+
+#include <Arduino.h>
+#include <array>
+#include <atomic>
+#include <esp_timer.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifndef TRACE_BUFFER_SIZE
+#define TRACE_BUFFER_SIZE 512 // records in the trace ring, must be a power of two
+#endif
+
+/// @brief Traced events. Events ending in _BEGIN/_ENTER/_START are paired with the next event, which ends the span. Keep in sync with trace_to_chrome.py.
+enum TraceEvent : uint8_t
+{
+    TRACE_TX_START,          // LoRa transmission started
+    TRACE_TX_DONE,           // LoRa transmission finished (DIO0 raised)
+    TRACE_RX_START,          // LoRa receive window opened
+    TRACE_RX_IRQ,            // LoRa frame received (DIO0 raised), closes the receive window
+    TRACE_RX_TIMEOUT,        // LoRa receive window expired, closes the receive window
+    TRACE_LIGHT_SLEEP_ENTER, // light sleep entered
+    TRACE_LIGHT_SLEEP_EXIT,  // light sleep exited
+    TRACE_FLASH_BEGIN,       // sensor data file operation started
+    TRACE_FLASH_END,         // sensor data file operation finished
+    TRACE_COMM_BEGIN,        // comm period with a node/gateway started, argument holds the last two bytes of its MAC address
+    TRACE_COMM_END,          // comm period with a node/gateway finished, argument holds 1 on success
+};
+
+/// @brief Single trace record, written to the trace ring as is.
+struct TraceRecord
+{
+    /// @brief Time of the event (esp_timer_get_time, µs), truncated to 32 bits.
+    uint32_t timeUs;
+    TraceEvent event;
+    /// @brief Core on which the event was recorded.
+    uint8_t core;
+    /// @brief Event-specific argument.
+    uint16_t arg;
+} __attribute__((packed));
+
+/// @brief Fixed-size, lock-free ring of timestamped events, cheap enough to record from hot paths on either core. The ring is not retained through deep
+/// sleep, and is dumped in binary with the 'trace' command, to be converted to Chrome trace_event JSON by trace_to_chrome.py.
+class Trace
+{
+    static_assert(TRACE_BUFFER_SIZE > 0 && (TRACE_BUFFER_SIZE & (TRACE_BUFFER_SIZE - 1)) == 0, "TRACE_BUFFER_SIZE must be a power of two.");
+
+    static std::array<TraceRecord, TRACE_BUFFER_SIZE> buffer;
+    /// @brief Amount of records ever recorded.
+    static std::atomic<uint32_t> head;
+
+public:
+    /// @brief Magic bytes starting a dump.
+    static constexpr char magic[4]{'T', 'R', 'C', '1'};
+
+    /// @brief Records an event, overwriting the oldest record if the ring is full.
+    /// @param event The event.
+    /// @param arg Event-specific argument.
+    static void record(TraceEvent event, uint16_t arg = 0)
+    {
+        uint32_t i{head.fetch_add(1, std::memory_order_relaxed)};
+        buffer[i % TRACE_BUFFER_SIZE] = TraceRecord{static_cast<uint32_t>(esp_timer_get_time()), event, static_cast<uint8_t>(xPortGetCoreID()), arg};
+    }
+    /// @brief Writes the ring to the output stream, oldest record first, with the following layout: "(magic, 4 bytes)(record count, 4 bytes)(records
+    /// overwritten, 4 bytes)(record)...". Recording concurrently with a dump may yield a torn record.
+    /// @param out The output stream.
+    static void dump(Print& out);
+    /// @brief Empties the ring.
+    static void clear() { head.store(0, std::memory_order_relaxed); }
+};
+
+#endif
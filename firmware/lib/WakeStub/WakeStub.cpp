@@ -0,0 +1,134 @@
+#include "WakeStub.h"
+#include <Arduino.h>
+#include <driver/adc.h>
+#include <driver/rtc_io.h>
+#include <esp32/clk.h>
+#include <esp32/rom/ets_sys.h>
+#include <esp32/rom/rtc.h>
+#include <esp_adc_cal.h>
+#include <esp_sleep.h>
+#include <soc/rtc.h>
+#include <soc/rtc_cntl_reg.h>
+#include <soc/rtc_io_reg.h>
+#include <soc/sens_reg.h>
+#include <soc/timer_group_reg.h>
+
+RTC_DATA_ATTR WakeStub::Schedule stubSchedule{};
+
+WakeStub::Schedule& WakeStub::getSchedule() { return stubSchedule; }
+
+bool WakeStub::addChannel(uint8_t sensorIndex, int8_t pin, int8_t enablePin, uint32_t interval, uint32_t nextSampleTime)
+{
+    int8_t adcChannel{pin < 0 ? static_cast<int8_t>(-1) : digitalPinToAnalogChannel(pin)};
+    // ADC2 is shared with WiFi and has no RTC controller of its own
+    if (adcChannel < 0 || adcChannel >= ADC1_CHANNEL_MAX)
+        return false;
+    int enableRTCGPIO{enablePin < 0 ? -1 : rtc_io_number_get(static_cast<gpio_num_t>(enablePin))};
+    if (enablePin >= 0 && enableRTCGPIO < 0)
+        return false;
+    return stubSchedule.addChannel({sensorIndex, static_cast<uint8_t>(adcChannel), enablePin, static_cast<int8_t>(enableRTCGPIO), interval, nextSampleTime});
+}
+
+bool WakeStub::arm(uint32_t time, uint32_t fullBootTime, bool fullBootByAlarm, uint32_t coalesceWindow)
+{
+    if (stubSchedule.getNChannels() == 0)
+    {
+        stubSchedule.disarm();
+        return false;
+    }
+    adc1_config_width(ADC_WIDTH_BIT_12);
+    for (size_t i{0}; i < stubSchedule.getNChannels(); i++)
+    {
+        const Schedule::Channel& channel{stubSchedule.getChannels()[i]};
+        adc1_config_channel_atten(static_cast<adc1_channel_t>(channel.adcChannel), ADC_ATTEN_DB_11);
+        if (channel.enablePin < 0)
+            continue;
+        gpio_num_t enablePin{static_cast<gpio_num_t>(channel.enablePin)};
+        rtc_gpio_init(enablePin);
+        rtc_gpio_set_direction(enablePin, RTC_GPIO_MODE_OUTPUT_ONLY);
+        rtc_gpio_set_level(enablePin, 0);
+    }
+    // the RTC IO and ADC configuration is lost when the RTC peripherals are powered down
+    esp_sleep_pd_config(ESP_PD_DOMAIN_RTC_PERIPH, ESP_PD_OPTION_ON);
+    uint32_t ticksPerSecond{static_cast<uint32_t>((1000000ULL << RTC_CLK_CAL_FRACT) / esp_clk_slowclk_cal_get())};
+    stubSchedule.arm(time, rtc_time_get(), ticksPerSecond, fullBootTime, fullBootByAlarm, coalesceWindow);
+    return true;
+}
+
+uint32_t WakeStub::toMilliVolts(uint16_t raw)
+{
+    static esp_adc_cal_characteristics_t characteristics;
+    static bool characterised{false};
+    if (!characterised)
+    {
+        esp_adc_cal_characterize(ADC_UNIT_1, ADC_ATTEN_DB_11, ADC_WIDTH_BIT_12, 1100, &characteristics);
+        characterised = true;
+    }
+    return esp_adc_cal_raw_to_voltage(raw, &characteristics);
+}
+
+/// @brief Converts a channel with ADC1's RTC controller, as configured by WakeStub::arm. Runs in the wake stub: only registers and ROM functions are used.
+static uint16_t RTC_IRAM_ATTR convert(const WakeStub::Schedule::Channel& channel)
+{
+    if (channel.enableRTCGPIO >= 0)
+    {
+        REG_WRITE(RTC_GPIO_OUT_W1TS_REG, BIT(channel.enableRTCGPIO + RTC_GPIO_OUT_DATA_W1TS_S));
+        ets_delay_us(WAKE_STUB_ENABLE_SETTLE);
+    }
+    REG_SET_FIELD(SENS_SAR_MEAS_WAIT2_REG, SENS_FORCE_XPD_SAR, SENS_FORCE_XPD_SAR_PU);
+    CLEAR_PERI_REG_MASK(SENS_SAR_READ_CTRL_REG, SENS_SAR1_DIG_FORCE);
+    SET_PERI_REG_MASK(SENS_SAR_MEAS_START1_REG, SENS_MEAS1_START_FORCE | SENS_SAR1_EN_PAD_FORCE);
+    REG_SET_FIELD(SENS_SAR_MEAS_START1_REG, SENS_SAR1_EN_PAD, BIT(channel.adcChannel));
+    CLEAR_PERI_REG_MASK(SENS_SAR_MEAS_START1_REG, SENS_MEAS1_START_SAR);
+    SET_PERI_REG_MASK(SENS_SAR_MEAS_START1_REG, SENS_MEAS1_START_SAR);
+    for (size_t us{0}; !GET_PERI_REG_MASK(SENS_SAR_MEAS_START1_REG, SENS_MEAS1_DONE_SAR) && us < WAKE_STUB_CONVERSION_TIMEOUT; us++)
+        ets_delay_us(1);
+    uint16_t raw{static_cast<uint16_t>(REG_GET_FIELD(SENS_SAR_MEAS_START1_REG, SENS_MEAS1_DATA_SAR))};
+    REG_SET_FIELD(SENS_SAR_MEAS_WAIT2_REG, SENS_FORCE_XPD_SAR, SENS_FORCE_XPD_SAR_FSM);
+    if (channel.enableRTCGPIO >= 0)
+        REG_WRITE(RTC_GPIO_OUT_W1TC_REG, BIT(channel.enableRTCGPIO + RTC_GPIO_OUT_DATA_W1TC_S));
+    return raw;
+}
+
+/// @return The current RTC slow clock tick. Same as rtc_time_get, which is not available in the wake stub.
+static uint64_t RTC_IRAM_ATTR tickNow()
+{
+    SET_PERI_REG_MASK(RTC_CNTL_TIME_UPDATE_REG, RTC_CNTL_TIME_UPDATE);
+    while (GET_PERI_REG_MASK(RTC_CNTL_TIME_UPDATE_REG, RTC_CNTL_TIME_VALID) == 0)
+        ets_delay_us(1);
+    SET_PERI_REG_MASK(RTC_CNTL_INT_CLR_REG, RTC_CNTL_TIME_VALID_INT_CLR);
+    return READ_PERI_REG(RTC_CNTL_TIME0_REG) | (static_cast<uint64_t>(READ_PERI_REG(RTC_CNTL_TIME1_REG)) << 32);
+}
+
+/// @brief Deep sleep wake stub, replacing the default one of ESP-IDF. Returning from it boots the firmware.
+void RTC_IRAM_ATTR esp_wake_deep_sleep(void)
+{
+    esp_default_wake_deep_sleep();
+    // the external RTC alarm (ext0) wakes the next full boot, the BOOT button (ext1) the command phase
+    if ((REG_GET_FIELD(RTC_CNTL_WAKEUP_STATE_REG, RTC_CNTL_WAKEUP_CAUSE) & RTC_TIMER_TRIG_EN) == 0)
+        return;
+    uint64_t wakeTick{0};
+    WakeStub::Schedule::Action action{stubSchedule.wake(tickNow(), convert, wakeTick)};
+    if (action == WakeStub::Schedule::FULL_BOOT)
+        return;
+    REG_WRITE(TIMG_WDTFEED_REG(0), 1);
+    uint32_t wakeSources{REG_GET_FIELD(RTC_CNTL_WAKEUP_STATE_REG, RTC_CNTL_WAKEUP_ENA)};
+    if (action == WakeStub::Schedule::SLEEP)
+    {
+        WRITE_PERI_REG(RTC_CNTL_SLP_TIMER0_REG, wakeTick & UINT32_MAX);
+        WRITE_PERI_REG(RTC_CNTL_SLP_TIMER1_REG, wakeTick >> 32);
+        wakeSources |= RTC_TIMER_TRIG_EN;
+    }
+    else
+    {
+        wakeSources &= ~RTC_TIMER_TRIG_EN;
+    }
+    REG_SET_FIELD(RTC_CNTL_WAKEUP_STATE_REG, RTC_CNTL_WAKEUP_ENA, wakeSources);
+    // RTC fast memory, which holds the wake stub, is checked against its CRC on wake
+    set_rtc_memory_crc();
+    REG_WRITE(RTC_ENTRY_ADDR_REG, reinterpret_cast<uint32_t>(&esp_wake_deep_sleep));
+    CLEAR_PERI_REG_MASK(RTC_CNTL_STATE0_REG, RTC_CNTL_SLEEP_EN);
+    SET_PERI_REG_MASK(RTC_CNTL_STATE0_REG, RTC_CNTL_SLEEP_EN);
+    while (true)
+        ;
+}
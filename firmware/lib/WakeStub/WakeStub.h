@@ -0,0 +1,47 @@
+#ifndef __WAKE_STUB_H__
+#define __WAKE_STUB_H__
+
+#include <esp_attr.h>
+#include <stdint.h>
+
+#define WAKE_STUB_FUNC RTC_IRAM_ATTR
+#include "WakeStubSchedule.h"
+
+#define WAKE_STUB_MAX_CHANNELS 4 // sensors sampled by the wake stub
+#define WAKE_STUB_BUFFER_SIZE 96 // samples buffered in RTC memory before the firmware is booted to store them
+#define WAKE_STUB_ENABLE_SETTLE 100 // us, time between raising a channel's enable pin and its conversion
+#define WAKE_STUB_CONVERSION_TIMEOUT 1000 // us
+
+/// @brief Samples sensors that only need a single ADC1 conversion (e.g. battery voltage) from the deep sleep wake stub, which runs from RTC memory right after
+/// wake, before the firmware is loaded. Timer wakes for such sensors only take the conversion and return to deep sleep, the firmware is booted when the buffer
+/// is full, on the external RTC alarm or any other wake source. The firmware stores the buffered samples on the next full boot.
+/// @see WakeStubSchedule
+class WakeStub
+{
+public:
+    using Schedule = WakeStubSchedule<WAKE_STUB_MAX_CHANNELS, WAKE_STUB_BUFFER_SIZE>;
+
+    /// @return The wake stub's schedule and sample buffer, held in RTC memory.
+    static Schedule& getSchedule();
+    /// @brief Adds a sensor to be sampled by the wake stub.
+    /// @param sensorIndex Index of the sensor in the node's sensor set.
+    /// @param pin ADC pin of the sensor, must be an ADC1 pin.
+    /// @param enablePin Pin to drive high during the conversion, must be an RTC GPIO. -1 for none.
+    /// @param interval Sample interval in s.
+    /// @param nextSampleTime Next scheduled sample time.
+    /// @return Whether the sensor can be sampled by the wake stub, false if its interval is 0.
+    static bool addChannel(uint8_t sensorIndex, int8_t pin, int8_t enablePin, uint32_t interval, uint32_t nextSampleTime);
+    /// @brief Configures the ADC and the enable pins of the channels to be kept through deep sleep and arms the wake stub. To be called right before deep
+    /// sleep, does nothing if there are no channels.
+    /// @param time The current time.
+    /// @param fullBootTime Time of the next full boot.
+    /// @param fullBootByAlarm Whether the full boot is woken by the external RTC alarm rather than the internal timer.
+    /// @param coalesceWindow Samples within this time (s) before the full boot are left to the full boot.
+    /// @return Whether the wake stub was armed.
+    static bool arm(uint32_t time, uint32_t fullBootTime, bool fullBootByAlarm, uint32_t coalesceWindow);
+    /// @param raw A raw ADC value taken by the wake stub.
+    /// @return The value in mV, using the ADC's factory calibration.
+    static uint32_t toMilliVolts(uint16_t raw);
+};
+
+#endif
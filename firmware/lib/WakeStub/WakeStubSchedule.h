@@ -0,0 +1,188 @@
+#ifndef __WAKE_STUB_SCHEDULE_H__
+#define __WAKE_STUB_SCHEDULE_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifndef WAKE_STUB_FUNC
+#define WAKE_STUB_FUNC // defined by WakeStub.h to place the functions in RTC fast memory, so that they can run in the wake stub
+#endif
+
+/// @brief Schedule of the sensors sampled by the deep sleep wake stub, along with the buffer of their samples. Kept in RTC memory, it is armed by the
+/// firmware right before deep sleep and run by the wake stub on each timer wake, until the buffer fills or the next full boot (comm period or a sensor that
+/// needs the firmware) is due. It has no platform dependencies, so that it can run in the wake stub (where only RTC memory and ROM functions are available)
+/// as well as on the host.
+///
+/// Times are in seconds from UNIX epoch. The wake stub only has the RTC slow clock, of which the tick at the time of arming is kept to convert between both.
+/// @tparam maxChannels Maximum amount of sampled sensors.
+/// @tparam bufferSize Maximum amount of buffered samples.
+template <size_t maxChannels, size_t bufferSize> class WakeStubSchedule
+{
+public:
+    /// @brief A sensor sampled by the wake stub.
+    struct Channel
+    {
+        /// @brief Index of the sensor in the node's sensor set.
+        uint8_t sensorIndex{0};
+        /// @brief ADC1 channel to convert.
+        uint8_t adcChannel{0};
+        /// @brief Pin to drive high during the conversion, -1 for none.
+        int8_t enablePin{-1};
+        /// @brief RTC GPIO number of the enable pin.
+        int8_t enableRTCGPIO{-1};
+        /// @brief Sample interval in s.
+        uint32_t interval{0};
+        /// @brief Next scheduled sample time.
+        uint32_t nextSampleTime{0};
+    };
+    /// @brief A conversion taken by the wake stub.
+    struct Sample
+    {
+        /// @brief Time the sample was taken.
+        uint32_t time;
+        /// @brief Index of the sensor in the node's sensor set.
+        uint8_t sensorIndex;
+        /// @brief Raw ADC value.
+        uint16_t raw;
+    };
+    /// @brief What the wake stub should do after a wake.
+    enum Action : uint8_t
+    {
+        SLEEP,             // sleep until the tick returned by wake
+        SLEEP_UNTIL_ALARM, // sleep until the external alarm of the next full boot, without timer
+        FULL_BOOT          // boot the firmware
+    };
+
+private:
+    bool armed{false};
+    uint32_t baseTime{0};
+    uint64_t baseTick{0};
+    uint32_t ticksPerSecond{0};
+    uint32_t fullBootTime{0};
+    bool fullBootByAlarm{false};
+    uint32_t coalesceWindow{0};
+    uint32_t nWakes{0};
+    uint8_t nChannels{0};
+    Channel channels[maxChannels]{};
+    uint8_t nSamples{0};
+    Sample samples[bufferSize]{};
+
+    WAKE_STUB_FUNC uint64_t toTick(uint32_t time) const
+    {
+        return time <= baseTime ? baseTick : baseTick + static_cast<uint64_t>(time - baseTime) * ticksPerSecond;
+    }
+    /// @return The time of a tick, rounded to the nearest second.
+    WAKE_STUB_FUNC uint32_t toTime(uint64_t tick) const
+    {
+        return tick <= baseTick ? baseTime : baseTime + static_cast<uint32_t>((tick - baseTick + ticksPerSecond / 2) / ticksPerSecond);
+    }
+    /// @return Whether the next sample of a channel is taken by the wake stub, rather than by the next full boot because it falls within the coalescing
+    /// window of (or after) the full boot.
+    WAKE_STUB_FUNC bool ownsNextSample(const Channel& channel) const { return channel.nextSampleTime + coalesceWindow < fullBootTime; }
+
+public:
+    constexpr WakeStubSchedule() = default;
+
+    /// @brief Removes all channels.
+    void clearChannels() { nChannels = 0; }
+    /// @brief Adds a channel.
+    /// @return Whether the channel was added, false if there is no room for it or if its interval is 0, which would never move its sample time on.
+    bool addChannel(const Channel& channel)
+    {
+        if (nChannels >= maxChannels || channel.interval == 0)
+            return false;
+        channels[nChannels++] = channel;
+        return true;
+    }
+    size_t getNChannels() const { return nChannels; }
+    const Channel* getChannels() const { return channels; }
+
+    /// @brief Arms the wake stub for the next deep sleep. To be called right before deep sleep, as the slow clock tick is taken to correspond to the time.
+    /// @param time The current time.
+    /// @param tick The current RTC slow clock tick.
+    /// @param ticksPerSecond Frequency of the RTC slow clock.
+    /// @param fullBootTime Time of the next full boot.
+    /// @param fullBootByAlarm Whether the full boot is woken by an external alarm rather than the timer, in which case the wake stub never boots the firmware
+    /// itself because of the time.
+    /// @param coalesceWindow Samples within this time (s) before the full boot are left to the full boot.
+    void arm(uint32_t time, uint64_t tick, uint32_t ticksPerSecond, uint32_t fullBootTime, bool fullBootByAlarm, uint32_t coalesceWindow)
+    {
+        this->baseTime = time;
+        this->baseTick = tick;
+        this->ticksPerSecond = ticksPerSecond;
+        this->fullBootTime = fullBootTime;
+        this->fullBootByAlarm = fullBootByAlarm;
+        this->coalesceWindow = coalesceWindow;
+        this->armed = nChannels > 0;
+    }
+    /// @brief Disarms the wake stub, so that every wake boots the firmware.
+    void disarm() { armed = false; }
+    bool isArmed() const { return armed; }
+
+    /// @return The earliest sample time of a channel that is taken by the wake stub, 0 if there is none.
+    WAKE_STUB_FUNC uint32_t nextSampleTime() const
+    {
+        uint32_t time{0};
+        for (size_t i{0}; i < nChannels; i++)
+        {
+            if (ownsNextSample(channels[i]) && (time == 0 || channels[i].nextSampleTime < time))
+                time = channels[i].nextSampleTime;
+        }
+        return time;
+    }
+
+    /// @brief Handles a timer wake of the wake stub: converts the channels that are due and buffers their samples. Samples missed while the buffer was full
+    /// are skipped.
+    /// @param tick The current RTC slow clock tick.
+    /// @param convert Takes a conversion of a channel and returns its raw value.
+    /// @param wakeTick Set to the tick to wake at, when SLEEP is returned.
+    /// @return What to do next. The firmware is booted when not armed, when the full boot is due or when a due sample does not fit the buffer, in which case
+    /// the firmware samples it.
+    WAKE_STUB_FUNC Action wake(uint64_t tick, uint16_t (*convert)(const Channel&), uint64_t& wakeTick)
+    {
+        if (!armed)
+            return FULL_BOOT;
+        // events up to half a second ahead are due, as the timer may fire slightly early
+        uint64_t dueTick{tick + ticksPerSecond / 2};
+        if (!fullBootByAlarm && toTick(fullBootTime) <= dueTick)
+            return FULL_BOOT;
+        nWakes++;
+        uint32_t time{toTime(tick)};
+        for (size_t i{0}; i < nChannels; i++)
+        {
+            Channel& channel{channels[i]};
+            if (!ownsNextSample(channel) || toTick(channel.nextSampleTime) > dueTick)
+                continue;
+            if (nSamples >= bufferSize)
+                return FULL_BOOT;
+            samples[nSamples].time = time;
+            samples[nSamples].sensorIndex = channel.sensorIndex;
+            samples[nSamples].raw = convert(channel);
+            nSamples++;
+            while (toTick(channel.nextSampleTime) <= dueTick)
+                channel.nextSampleTime += channel.interval;
+        }
+        uint32_t wakeTime{nextSampleTime()};
+        if (wakeTime == 0)
+        {
+            if (fullBootByAlarm)
+                return SLEEP_UNTIL_ALARM;
+            wakeTime = fullBootTime;
+        }
+        wakeTick = toTick(wakeTime);
+        return SLEEP;
+    }
+
+    size_t getNSamples() const { return nSamples; }
+    const Sample* getSamples() const { return samples; }
+    /// @return The amount of wakes handled by the wake stub since the samples were last cleared.
+    uint32_t getNWakes() const { return nWakes; }
+    /// @brief Clears the buffered samples and the wake count, once they have been stored by the firmware.
+    void clearSamples()
+    {
+        nSamples = 0;
+        nWakes = 0;
+    }
+};
+
+#endif
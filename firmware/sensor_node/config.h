@@ -31,6 +31,8 @@
 #define DEFAULT_SAMPLING_INTERVAL (60 * 60) // s, default sensor sampling interval to resort to when no communication with gateway is established
 #define DEFAULT_SAMPLING_ROUNDING (60)      // s, round sampling time to nearest... (only used in case of DEFAULT_SAMPLING_INTERVAL)
 #define DEFAULT_SAMPLING_OFFSET (0)
+#define WAKE_COALESCE_WINDOW 60 // s, max time a sample is moved earlier or later to share a wake with other sensors or with the comm period
+#define WAKE_SAMPLE_LEAD 2       // s, time before WAKE_COMM_PERIOD to wake when the comm period wake also samples, on top of the longest sensor conversion
 
 #define DISCOVERY_TIMEOUT (5 * 60 * 1000) // ms, time to wait for a discovery message from gateway
 
@@ -42,6 +44,12 @@
 
 #define MAX_SENSORDATA_FILESIZE 32 * 1024 // bytes
 #define MAX_SENSORS 20
+// sensors of the node, in order; their constructor arguments are given in SensorNode::initSensors
+#define SENSOR_TYPES RandomSensor, SoilTemperatureSensor, LightSensor, TempSHTSensor, HumiSHTSensor, BatterySensor, ESPCamUART
+#define SENSOR_LIGHT_SLEEP_THRESHOLD 5 // ms, minimum wait for a sensor conversion for which the node light sleeps instead of busy waiting
+#define WAKE_STUB_SAMPLING true // whether sensors that only need an ADC conversion (e.g. battery) are sampled by the deep sleep wake stub
+
+#define TELEMETRY_INTERVAL (6 * 60 * 60) // s, interval at which phase timing telemetry is stored along with the sensor data
 
 // Sensor pins
 
@@ -49,7 +57,7 @@
 #define BATT_EN_PIN 33
 
 #define SOILTEMP_PIN 17
-#define SOILTEMP_BUS_INDEX 0
+#define SOILTEMP_RESOLUTION 12 // bits (9 to 12) of the DS18B20 probes, the conversion takes 94, 188, 375 or 750 ms
 
 #define CAM_PIN GPIO_NUM_2
 
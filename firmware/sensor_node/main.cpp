@@ -15,7 +15,9 @@ void setup(void)
                                              .rtcIntPin = RTC_INT_PIN,
                                              .rtcAddress = RTC_ADDRESS};
     MIRRAModule::prepare(pins);
+    int64_t constructorStart{esp_timer_get_time()};
     SensorNode sensorNode = SensorNode(pins);
+    PhaseTiming::record(PHASE_CONSTRUCTOR, constructorStart);
     sensorNode.wake();
 }
 
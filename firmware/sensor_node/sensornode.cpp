@@ -1,12 +1,5 @@
 #include "sensornode.h"
 
-#include <BatterySensor.h>
-#include <ESPCamUART.h>
-#include <LightSensor.h>
-#include <RandomSensor.h>
-#include <SoilTempSensor.h>
-#include <TempHumiSensor.h>
-
 RTC_DATA_ATTR bool initialBoot = true;
 
 RTC_DATA_ATTR std::array<uint32_t, MAX_SENSORS> sensorsNextSampleTimes{0};
@@ -14,10 +7,71 @@ RTC_DATA_ATTR uint32_t sampleInterval{DEFAULT_SAMPLING_INTERVAL};
 RTC_DATA_ATTR uint32_t sampleRounding{DEFAULT_SAMPLING_ROUNDING};
 RTC_DATA_ATTR uint32_t sampleOffset{DEFAULT_SAMPLING_OFFSET};
 RTC_DATA_ATTR uint32_t nextSampleTime = -1;
+RTC_DATA_ATTR uint32_t nextBootSampleTime = -1; // next sample time of the sensors that the wake stub cannot sample
 RTC_DATA_ATTR uint32_t commInterval;
 RTC_DATA_ATTR uint32_t nextCommTime = -1;
 RTC_DATA_ATTR uint32_t maxMessages;
 RTC_DATA_ATTR MACAddress gatewayMAC;
+RTC_DATA_ATTR uint16_t nextSequence{0};
+RTC_DATA_ATTR uint32_t nextTelemetryTime{0};
+RTC_DATA_ATTR std::array<SensorSchedule, MAX_SENSORS> sensorSchedules{};
+RTC_DATA_ATTR uint8_t nSensorSchedules{0};
+RTC_DATA_ATTR std::array<uint32_t, MAX_SENSORS> sensorsNextEmitTimes{0}; // end of the current aggregation interval of each aggregated sensor
+RTC_DATA_ATTR std::array<SensorAggregate, MAX_SENSORS> sensorsAggregates{};
+RTC_DATA_ATTR ReportedValues<DEAD_BAND_MAX_VALUES> reportedValues{};
+RTC_DATA_ATTR std::array<uint32_t, MAX_SENSORS> sensorsConversionTimes{0}; // ms, as last reported by each sensor
+
+/// @return The sequence number of the next stored record, skipping the one reserved for the records filled in by the gateway.
+static uint16_t takeSequence()
+{
+    uint16_t sequence{nextSequence++};
+    if (nextSequence == Message<SENSOR_DATA>::filledSequence)
+        nextSequence = 0;
+    return sequence;
+}
+
+/// @brief Looks up the sampling schedule configured by the gateway for a sensor.
+/// @param id The sensor's type ID.
+/// @return The schedule, or nullptr if the sensor follows the node-wide sample interval.
+static const SensorSchedule* findSensorSchedule(uint8_t id)
+{
+    for (size_t i{0}; i < nSensorSchedules; i++)
+    {
+        if (sensorSchedules[i].appliesTo(id))
+            return &sensorSchedules[i];
+    }
+    return nullptr;
+}
+
+/// @return The time in seconds to wake ahead of the comm period when the comm period wake also samples: WAKE_SAMPLE_LEAD, plus the longest conversion
+/// time of the sensors.
+static uint32_t sampleLead()
+{
+    uint32_t longest{*std::max_element(sensorsConversionTimes.begin(), sensorsConversionTimes.end())};
+    return WAKE_SAMPLE_LEAD + (longest + 999) / 1000;
+}
+
+/// @param sampleTime Time of the next sample.
+/// @return Whether the next sample falls within WAKE_COALESCE_WINDOW of the comm period wake, and is therefore merged into that wake.
+static bool sampleMergedWithComm(uint32_t sampleTime = nextSampleTime)
+{
+    int64_t mergedWake{static_cast<int64_t>(WAKE_COMM_PERIOD(nextCommTime)) - sampleLead()};
+    return std::abs(static_cast<int64_t>(sampleTime) - mergedWake) <= WAKE_COALESCE_WINDOW;
+}
+
+/// @param sampleTime Time of the next sample.
+/// @return The time to wake for the next comm period, sampleLead() earlier if the next sample is merged into it.
+static uint32_t commWakeTime(uint32_t sampleTime = nextSampleTime)
+{
+    return WAKE_COMM_PERIOD(nextCommTime) - (sampleMergedWithComm(sampleTime) ? sampleLead() : 0);
+}
+
+/// @param sampleTime Time of the next sample.
+/// @return The time to wake next. A sample merged into the comm period wake is taken at that wake, up to WAKE_COALESCE_WINDOW early or late.
+static uint32_t nextWakeTime(uint32_t sampleTime = nextSampleTime)
+{
+    return sampleMergedWithComm(sampleTime) ? commWakeTime(sampleTime) : std::min(commWakeTime(sampleTime), sampleTime);
+}
 
 SensorNode::SensorNode(const MIRRAPins& pins) : MIRRAModule(pins)
 {
@@ -29,6 +83,7 @@ SensorNode::SensorNode(const MIRRAPins& pins) : MIRRAModule(pins)
             dataFile.close();
         }
         initSensors();
+        sensors.forEach([&](auto& sensor, size_t i) { sensorsConversionTimes[i] = sensor.getConversionTime(); });
         clearSensors();
         discovery();
         initialBoot = false;
@@ -38,9 +93,19 @@ SensorNode::SensorNode(const MIRRAPins& pins) : MIRRAModule(pins)
 void SensorNode::wake()
 {
     Log::debug("Running wake()...");
+    storeStubSamples();
     uint32_t cTime{rtc.getSysTime()};
-    if (cTime >= WAKE_COMM_PERIOD(nextCommTime))
+    if (cTime >= commWakeTime())
+    {
+        // a merged sample is taken first, so that its record is uploaded in this comm period
+        if (sampleMergedWithComm())
+            samplePeriod();
+        otherWorkThisWake = true;
+        const uint8_t* mac{gatewayMAC.getAddress()};
+        Trace::record(TRACE_COMM_BEGIN, mac[4] << 8 | mac[5]);
         commPeriod();
+        Trace::record(TRACE_COMM_END);
+    }
     cTime = rtc.getSysTime();
     if (cTime >= nextSampleTime)
     {
@@ -48,13 +113,25 @@ void SensorNode::wake()
     }
     cTime = rtc.getSysTime();
     Log::info("Next sample in ", nextSampleTime - cTime, "s, next comm period in ", nextCommTime - cTime, "s");
-    Serial.printf("Welcome! This is Sensor Node %s\n", lora.getMACAddress().toString());
-    commandEntry.prompt(Commands(this));
+    if (commandEntry.isRequested())
+    {
+        otherWorkThisWake = true;
+        Serial.printf("Welcome! This is Sensor Node %s\n", lora.getMACAddress().toString());
+        PhaseTiming::Scope timing{PHASE_COMMAND};
+        commandEntry.prompt(Commands(this));
+    }
     cTime = rtc.getSysTime();
-    if (cTime >= nextCommTime || cTime >= nextSampleTime)
+    if (cTime >= nextWakeTime())
         wake();
     Log::debug("Entering deep sleep...");
-    deepSleepUntil(std::min(WAKE_COMM_PERIOD(nextCommTime), nextSampleTime));
+    sampleOnlyWake = sampledThisWake && !otherWorkThisWake;
+    // the firmware only boots for the comm period and the sensors that need it, the wake stub samples the others in between
+    uint32_t fullBootTime{std::min(nextWakeTime(nextBootSampleTime), commWakeTime())};
+    cTime = rtc.getSysTime();
+    if (WakeStub::arm(cTime, fullBootTime, fullBootTime > cTime + DEEP_SLEEP_RTC_THRESHOLD, WAKE_COALESCE_WINDOW))
+        deepSleepUntil(fullBootTime, WakeStub::getSchedule().nextSampleTime());
+    else
+        deepSleepUntil(nextWakeTime());
 }
 
 void SensorNode::discovery()
@@ -67,7 +144,7 @@ void SensorNode::discovery()
         return;
     }
     const MACAddress& gatewayMAC = hello->getSource();
-    Log::info("Gateway found at ", gatewayMAC.toString(), ". Sending response message...");
+    Log::info("Gateway found at ", gatewayMAC, ". Sending response message...");
     lora.sendMessage(Message<HELLO_REPLY>(lora.getMACAddress(), gatewayMAC));
     Log::debug("Awaiting time config message...");
     auto timeConfig = lora.receiveMessage<TIME_CONFIG>(TIME_CONFIG_TIMEOUT, TIME_CONFIG_ATTEMPTS, gatewayMAC);
@@ -79,7 +156,7 @@ void SensorNode::discovery()
     this->timeConfig(*timeConfig);
     Log::debug("Time config message received. Sending TIME_ACK");
     lora.sendMessage(Message<ACK_TIME>(lora.getMACAddress(), gatewayMAC));
-    lora.receiveMessage<REPEAT>(TIME_CONFIG_TIMEOUT, 0, gatewayMAC);
+    awaitSensorConfig(gatewayMAC);
 }
 
 void SensorNode::timeConfig(Message<TIME_CONFIG>& m)
@@ -97,115 +174,307 @@ void SensorNode::timeConfig(Message<TIME_CONFIG>& m)
     if (!scheduleValid)
     {
         sensorsNextSampleTimes.fill(0);
+        sensorsNextEmitTimes.fill(0);
         initSensors();
         clearSensors();
     }
     Log::info("Sample interval: ", sampleInterval, ", Comm interval: ", commInterval, ", Max messages: ", maxMessages,
-              ", Gateway MAC: ", gatewayMAC.toString());
+              ", Gateway MAC: ", gatewayMAC);
 }
 
-void SensorNode::addSensor(std::unique_ptr<Sensor>&& sensor)
+void SensorNode::awaitSensorConfig(const MACAddress& gatewayMAC)
 {
-    if (nSensors > MAX_SENSORS)
+    // a REPEAT of the gateway is answered within receiveMessage, by resending the last acknowledgement
+    auto sensorConfig{lora.receiveMessage<SENSOR_CONFIG>(TIME_CONFIG_TIMEOUT, 0, gatewayMAC)};
+    if (!sensorConfig)
         return;
-    uint32_t cTime{rtc.getSysTime()};
-    if (sensorsNextSampleTimes[nSensors] == 0)
-    {
-        sensor->setNextSampleTime(((cTime / sampleRounding) * sampleRounding + sampleOffset));
-        while (sensor->getNextSampleTime() <= cTime)
-            sensor->updateNextSampleTime(sampleInterval);
-    }
-    else
+    this->sensorConfig(*sensorConfig);
+    Log::debug("Sensor config message received. Sending ACK_SENSOR_CONFIG");
+    lora.sendMessage(Message<ACK_SENSOR_CONFIG>(lora.getMACAddress(), gatewayMAC));
+    lora.receiveMessage<REPEAT>(TIME_CONFIG_TIMEOUT, 0, gatewayMAC);
+}
+
+void SensorNode::sensorConfig(Message<SENSOR_CONFIG>& m)
+{
+    nSensorSchedules = 0;
+    for (size_t i{0}; i < m.getNSchedules() && nSensorSchedules < MAX_SENSORS; i++)
     {
-        sensor->setNextSampleTime(sensorsNextSampleTimes[nSensors]);
+        const SensorSchedule& schedule{m.getSchedules()[i]};
+        if (schedule.interval == 0)
+            continue;
+        sensorSchedules[nSensorSchedules++] = schedule;
+        Log::info("Sensor tag ", schedule.tag, ": sample interval ", schedule.interval, ", offset ", schedule.offset, ", read interval ",
+                  schedule.readInterval, ", dead-band ", schedule.deadBand, ", max silence ", schedule.maxSilence);
     }
-    sensor->setup();
-    sensors[nSensors] = std::move(sensor);
-    nSensors++;
+    sensorsNextSampleTimes.fill(0);
+    sensorsNextEmitTimes.fill(0);
+    // the first value of each tag is stored again, so that the gateway knows where to fill in from
+    reportedValues.clear();
+    initSensors();
+    clearSensors();
 }
 
 void SensorNode::initSensors()
 {
-    addSensor(std::make_unique<RandomSensor>(rtc.getSysTime()));
-    addSensor(std::make_unique<SoilTemperatureSensor>(SOILTEMP_PIN, SOILTEMP_BUS_INDEX));
-    addSensor(std::make_unique<LightSensor>());
-    addSensor(std::make_unique<TempSHTSensor>());
-    addSensor(std::make_unique<HumiSHTSensor>(*reinterpret_cast<TempSHTSensor*>(sensors[nSensors - 1].get())));
-    addSensor(std::make_unique<BatterySensor>(BATT_PIN, BATT_EN_PIN));
-    addSensor(std::make_unique<ESPCamUART>(&Serial1, CAM_PIN));
+    // one tuple of constructor arguments per sensor, in the order of SENSOR_TYPES
+    sensors.emplace(std::forward_as_tuple(rtc.getSysTime()), std::forward_as_tuple(SOILTEMP_PIN, SOILTEMP_RESOLUTION), std::forward_as_tuple(),
+                    std::forward_as_tuple(), std::forward_as_tuple(sensors.get<TempSHTSensor>()), std::forward_as_tuple(BATT_PIN, BATT_EN_PIN),
+                    std::forward_as_tuple(&Serial1, CAM_PIN));
+    uint32_t cTime{rtc.getSysTime()};
+    sensors.forEach(
+        [&](auto& sensor, size_t i)
+        {
+            // a sensor schedule is aligned to multiples of its own interval, the readings of an aggregated sensor to multiples of its read interval
+            const SensorSchedule* schedule{findSensorSchedule(sensor.getID())};
+            bool aggregated{schedule && schedule->isAggregated()};
+            sensorsSampleIntervals[i] = schedule ? (aggregated ? schedule->readInterval : schedule->interval) : sampleInterval;
+            sensorsAggregateIntervals[i] = aggregated ? schedule->interval : 0;
+            sensorsDeadBands[i] = schedule && schedule->isDeadBanded() ? schedule->deadBand : 0;
+            sensorsMaxSilences[i] = schedule && schedule->isDeadBanded() ? schedule->maxSilence : 0;
+            if (sensorsNextSampleTimes[i] == 0)
+            {
+                uint32_t rounding{schedule ? sensorsSampleIntervals[i] : sampleRounding};
+                uint32_t offset{schedule ? schedule->offset % sensorsSampleIntervals[i] : sampleOffset};
+                sensor.setNextSampleTime(((cTime / rounding) * rounding + offset));
+                while (sensor.getNextSampleTime() <= cTime)
+                    sensor.updateNextSampleTime(sensorsSampleIntervals[i]);
+            }
+            else
+            {
+                sensor.setNextSampleTime(sensorsNextSampleTimes[i]);
+            }
+            if (aggregated && sensorsNextEmitTimes[i] == 0)
+            {
+                // the reading at the end of an interval starts the next one
+                sensorsNextEmitTimes[i] = (cTime / schedule->interval) * schedule->interval + schedule->offset % schedule->interval;
+                while (sensorsNextEmitTimes[i] <= sensor.getNextSampleTime())
+                    sensorsNextEmitTimes[i] += schedule->interval;
+                sensorsAggregates[i].reset();
+            }
+            sensor.setup();
+        });
 }
 
 void SensorNode::clearSensors()
 {
     nextSampleTime = -1;
-    for (size_t i{0}; i < nSensors; i++)
+    nextBootSampleTime = -1;
+    WakeStub::getSchedule().clearChannels();
+    sensors.forEach(
+        [&](auto& sensor, size_t i)
+        {
+            sensorsNextSampleTimes[i] = sensor.getNextSampleTime();
+            if (sensor.getNextSampleTime() < nextSampleTime)
+                nextSampleTime = sensor.getNextSampleTime();
+            if (!WAKE_STUB_SAMPLING ||
+                !WakeStub::addChannel(i, sensor.getStubPin(), sensor.getStubEnablePin(), sensorsSampleIntervals[i], sensor.getNextSampleTime()))
+                nextBootSampleTime = std::min(nextBootSampleTime, sensor.getNextSampleTime());
+        });
+    sensors.clear();
+}
+
+void SensorNode::storeStubSamples()
+{
+    WakeStub::Schedule& stub{WakeStub::getSchedule()};
+    stub.disarm();
+    if (stub.getNSamples() == 0)
+        return;
+    Log::info("Storing ", stub.getNSamples(), " samples taken by the wake stub in ", stub.getNWakes(), " wakes...");
+    initSensors();
+    const WakeStub::Schedule::Sample* samples{stub.getSamples()};
+    std::array<SensorValue, Message<SENSOR_DATA>::maxNValues> values;
+    uint8_t nValues{0};
+    File data = LittleFS.open(DATA_FP, FILE_APPEND);
+    for (size_t i{0}; i < stub.getNSamples(); i++)
+    {
+        sensors.forEach(
+            [&](auto& sensor, size_t index)
+            {
+                if (index != samples[i].sensorIndex)
+                    return;
+                SensorValue value{sensor.fromStubSample(samples[i].raw, WakeStub::toMilliVolts(samples[i].raw))};
+                if (sensorsAggregateIntervals[index] > 0)
+                    aggregate(index, samples[i].time, value, values, nValues);
+                else if (isReported(index, samples[i].time, value))
+                    values[nValues++] = value;
+            });
+        // samples taken at the same time share a record, which is left out if all of them were aggregated or dead-banded
+        if (i + 1 == stub.getNSamples() || samples[i + 1].time != samples[i].time || values.size() - nValues < SensorAggregate::STATISTIC_COUNT)
+        {
+            if (nValues > 0)
+                storeSensorData(Message<SENSOR_DATA>(lora.getMACAddress(), gatewayMAC, takeSequence(), samples[i].time, nValues, values), data);
+            nValues = 0;
+        }
+    }
+    data.close();
+    // the wake stub has moved on the sample times of its sensors
+    for (size_t i{0}; i < stub.getNChannels(); i++)
     {
-        sensorsNextSampleTimes[i] = sensors[i]->getNextSampleTime();
-        if (sensors[i]->getNextSampleTime() < nextSampleTime)
-            nextSampleTime = sensors[i]->getNextSampleTime();
-        sensors[i].reset();
+        const WakeStub::Schedule::Channel& channel{stub.getChannels()[i]};
+        sensors.forEach(
+            [&](auto& sensor, size_t index)
+            {
+                if (index == channel.sensorIndex)
+                    sensor.setNextSampleTime(channel.nextSampleTime);
+            });
     }
-    nSensors = 0;
+    stub.clearSamples();
+    clearSensors();
 }
 
-Message<SENSOR_DATA> SensorNode::sampleAll()
+void SensorNode::measure(const std::array<bool, NodeSensors::size>& selected,
+                         std::array<std::array<SensorValue, SENSOR_MAX_VALUES>, NodeSensors::size>& results, std::array<size_t, NodeSensors::size>& nResults)
 {
-    Log::info("Sampling all sensors...");
-    for (size_t i{0}; i < nSensors; i++)
+    // start all conversions at once, so the awake time is bounded by the longest conversion rather than by their sum
+    std::array<uint32_t, NodeSensors::size> readyTimes;
+    std::array<bool, NodeSensors::size> pending{};
+    size_t nPending{0};
+    sensors.forEach(
+        [&](auto& sensor, size_t i)
+        {
+            if (!selected[i])
+                return;
+            Log::debug("Starting measurement for ", sensor.getID());
+            sensor.startMeasurement();
+            sensorsConversionTimes[i] = sensor.getConversionTime();
+            readyTimes[i] = millis() + sensorsConversionTimes[i];
+            pending[i] = true;
+            nPending++;
+        });
+    // collect the results in order of readiness, light sleeping until the earliest pending conversion is ready
+    nResults.fill(0);
+    for (; nPending > 0; nPending--)
     {
-        Serial.printf("Starting measurement for %u\n", sensors[i]->getID());
-        sensors[i]->startMeasurement();
+        size_t next{0};
+        for (size_t i{0}; i < NodeSensors::size; i++)
+        {
+            if (pending[i] && (!pending[next] || static_cast<int32_t>(readyTimes[i] - readyTimes[next]) < 0))
+                next = i;
+        }
+        int32_t remaining{static_cast<int32_t>(readyTimes[next] - millis())};
+        if (remaining >= SENSOR_LIGHT_SLEEP_THRESHOLD)
+            lightSleep(remaining / 1000.0f);
+        else if (remaining > 0)
+            delay(remaining);
+        sensors.forEach(
+            [&](auto& sensor, size_t i)
+            {
+                if (i != next)
+                    return;
+                Log::debug("Getting measurement for ", sensor.getID());
+                nResults[i] = sensor.getMeasurements(results[i].data(), results[i].size());
+            });
+        pending[next] = false;
     }
-    std::array<SensorValue, Message<SENSOR_DATA>::maxNValues> values;
-    for (size_t i{0}; i < nSensors; i++)
+}
+
+void SensorNode::aggregate(size_t index, uint32_t time, const SensorValue& value, std::array<SensorValue, Message<SENSOR_DATA>::maxNValues>& values,
+                           uint8_t& nValues)
+{
+    SensorAggregate& stats{sensorsAggregates[index]};
+    if (time >= sensorsNextEmitTimes[index])
     {
-        Serial.printf("Getting measurement for %u\n", sensors[i]->getID());
-        values[i] = sensors[i]->getMeasurement();
+        nValues += stats.emit(value.tag >> 4, values.data() + nValues, values.size() - nValues);
+        stats.reset();
+        while (sensorsNextEmitTimes[index] <= time)
+            sensorsNextEmitTimes[index] += sensorsAggregateIntervals[index];
     }
-    return Message<SENSOR_DATA>(lora.getMACAddress(), gatewayMAC, 0, static_cast<uint8_t>(nSensors), values);
+    stats.add(value.value);
 }
 
-Message<SENSOR_DATA> SensorNode::sampleScheduled(uint32_t cTime)
+bool SensorNode::isReported(size_t index, uint32_t time, const SensorValue& value)
 {
-    Log::info("Sampling scheduled sensors...");
-    for (size_t i{0}; i < nSensors; i++)
+    return sensorsDeadBands[index] == 0 || reportedValues.report(value, time, sensorsDeadBands[index], sensorsMaxSilences[index]);
+}
+
+Message<SENSOR_DATA> SensorNode::sampleAll()
+{
+    Log::info("Sampling all sensors...");
+    std::array<bool, NodeSensors::size> selected;
+    selected.fill(true);
+    std::array<std::array<SensorValue, SENSOR_MAX_VALUES>, NodeSensors::size> results;
+    std::array<size_t, NodeSensors::size> nResults;
+    measure(selected, results, nResults);
+    std::array<SensorValue, Message<SENSOR_DATA>::maxNValues> values;
+    uint8_t nValues{0};
+    for (size_t i{0}; i < NodeSensors::size; i++)
     {
-        if (sensors[i]->getNextSampleTime() == cTime)
-            sensors[i]->startMeasurement();
+        for (size_t j{0}; j < nResults[i] && nValues < values.size(); j++)
+            values[nValues++] = results[i][j];
     }
+    return Message<SENSOR_DATA>(lora.getMACAddress(), gatewayMAC, 0, 0, nValues, values);
+}
+
+Message<SENSOR_DATA> SensorNode::sampleScheduled(uint32_t until)
+{
+    PhaseTiming::Scope timing{PHASE_SAMPLE};
+    Log::info("Sampling scheduled sensors...");
+    std::array<bool, NodeSensors::size> selected;
+    std::array<uint32_t, NodeSensors::size> readTimes;
+    sensors.forEach(
+        [&](auto& sensor, size_t i)
+        {
+            readTimes[i] = sensor.getNextSampleTime();
+            selected[i] = readTimes[i] <= until;
+        });
+    if (!sampledThisWake)
+        PhaseTiming::record(PHASE_TO_SAMPLE, 0);
+    sampledThisWake = true;
+    std::array<std::array<SensorValue, SENSOR_MAX_VALUES>, NodeSensors::size> results;
+    std::array<size_t, NodeSensors::size> nResults;
+    // sensors sampled ahead of or behind their schedule to share this wake are stored with the time they are actually read
+    uint32_t readTime{rtc.getSysTime()};
+    measure(selected, results, nResults);
     std::array<SensorValue, Message<SENSOR_DATA>::maxNValues> values;
     uint8_t nValues{0};
-    for (size_t i{0}; i < nSensors; i++)
+    for (size_t i{0}; i < NodeSensors::size; i++)
     {
-        if (sensors[i]->getNextSampleTime() == cTime)
+        if (sensorsAggregateIntervals[i] > 0 && nResults[i] == 1)
+        {
+            aggregate(i, readTimes[i], results[i][0], values, nValues);
+            continue;
+        }
+        // the instance bits hold the statistic, which leaves none for sensors that measure several values
+        if (sensorsAggregateIntervals[i] > 0 && nResults[i] > 1)
+            Log::error("Sensor ", i, " measures several values, which cannot be aggregated. Storing them as they are.");
+        for (size_t j{0}; j < nResults[i] && nValues < values.size(); j++)
         {
-            values[nValues] = sensors[i]->getMeasurement();
-            nValues++;
+            if (isReported(i, readTimes[i], results[i][j]))
+                values[nValues++] = results[i][j];
         }
     }
-    return Message<SENSOR_DATA>(lora.getMACAddress(), gatewayMAC, cTime, nValues, values);
+    return Message<SENSOR_DATA>(lora.getMACAddress(), gatewayMAC, nValues > 0 ? takeSequence() : 0, readTime, nValues, values);
 }
 
 void SensorNode::updateSensorsSampleTimes(uint32_t cTime)
 {
-    for (size_t i = 0; i < nSensors; i++)
-    {
-        while (sensors[i]->getNextSampleTime() <= cTime)
-            sensors[i]->updateNextSampleTime(sampleInterval);
-    }
+    sensors.forEach(
+        [&](auto& sensor, size_t i)
+        {
+            while (sensor.getNextSampleTime() <= cTime)
+                sensor.updateNextSampleTime(sensorsSampleIntervals[i]);
+        });
 }
 void SensorNode::samplePeriod()
 {
     initSensors();
-    auto lambdaByNextSampleTime = [](const std::unique_ptr<Sensor>& a, const std::unique_ptr<Sensor>& b)
-    { return a->getNextSampleTime() < b->getNextSampleTime(); };
-    uint32_t cTime{(*std::min_element(sensors.begin(), std::next(sensors.begin(), nSensors), lambdaByNextSampleTime))->getNextSampleTime()};
-    Message<SENSOR_DATA> message{sampleScheduled(cTime)};
+    uint32_t cTime{UINT32_MAX};
+    sensors.forEach([&](auto& sensor, size_t) { cTime = std::min(cTime, sensor.getNextSampleTime()); });
+    // sensors due within WAKE_COALESCE_WINDOW from now share this wake, the earliest is sampled even if this sample period was forced ahead of time
+    uint32_t until{std::max(cTime, rtc.getSysTime() + WAKE_COALESCE_WINDOW)};
+    Message<SENSOR_DATA> message{sampleScheduled(until)};
     Log::debug("Constructed Sensor Message with length ", message.getLength());
     File data = LittleFS.open(DATA_FP, FILE_APPEND);
-    storeSensorData(message, data);
+    if (message.getNValues() > 0)
+        storeSensorData(message, data);
+    if (cTime >= nextTelemetryTime)
+    {
+        Log::debug("Storing phase timing telemetry...");
+        storeSensorData(phaseTimingMessage(gatewayMAC, takeSequence(), cTime), data);
+        nextTelemetryTime = cTime + TELEMETRY_INTERVAL;
+    }
     data.close();
-    updateSensorsSampleTimes(cTime);
+    updateSensorsSampleTimes(until);
     clearSensors();
 }
 
@@ -220,7 +489,7 @@ void SensorNode::commPeriod()
         return;
     }
     MACAddress _gatewayMAC{gatewayMAC}; // avoid access to slow RTC memory
-    Log::info("Communicating with gateway ", _gatewayMAC.toString(), " ...");
+    Log::info("Communicating with gateway ", _gatewayMAC, " ...");
     uint32_t _maxMessages{maxMessages}; // avoid access to slow RTC memory
     Log::debug("Max messages to send: ", _maxMessages);
     std::vector<Message<SENSOR_DATA>> messages;
@@ -300,7 +569,7 @@ bool SensorNode::sendSensorMessage(Message<SENSOR_DATA>& message, MACAddress con
         {
             this->timeConfig(*timeConfig);
             lora.sendMessage(Message<ACK_TIME>(lora.getMACAddress(), dest));
-            lora.receiveMessage<REPEAT>(TIME_CONFIG_TIMEOUT, 0, gatewayMAC);
+            awaitSensorConfig(dest);
             return 1;
         }
         else
@@ -328,7 +597,7 @@ CommandCode SensorNode::Commands::printSample()
 {
     parent->initSensors();
     Message<SENSOR_DATA> message{parent->sampleAll()};
-    auto& values = message.getValues();
+    SensorValue* values{message.getValues()};
     Serial.println("TAG\tVALUE");
     for (size_t i{0}, nValues{message.getNValues()}; i < nValues; i++)
     {
@@ -343,15 +612,17 @@ CommandCode SensorNode::Commands::printSchedule()
     parent->initSensors();
     constexpr size_t timeLength{sizeof("0000-00-00 00:00:00")};
     char buffer[timeLength]{0};
-    Serial.println("TAG\tNEXT SAMPLE");
-    for (size_t i{0}; i < parent->nSensors; i++)
-    {
-        tm time;
-        time_t nextSensorSampleTime{static_cast<time_t>(parent->sensors[i]->getNextSampleTime())};
-        gmtime_r(&nextSensorSampleTime, &time);
-        strftime(buffer, timeLength, "%F %T", &time);
-        Serial.printf("%u\t%s\n", parent->sensors[i]->getID(), buffer);
-    }
+    Serial.println("TAG\tINTERVAL\tAGGREGATE INTERVAL\tNEXT SAMPLE");
+    parent->sensors.forEach(
+        [&](auto& sensor, size_t i)
+        {
+            tm time;
+            time_t nextSensorSampleTime{static_cast<time_t>(sensor.getNextSampleTime())};
+            gmtime_r(&nextSensorSampleTime, &time);
+            strftime(buffer, timeLength, "%F %T", &time);
+            Serial.printf("%u\t%u\t%u\t%s\n", SensorValue(sensor.getID(), 0, 0).tag, parent->sensorsSampleIntervals[i], parent->sensorsAggregateIntervals[i],
+                          buffer);
+        });
     parent->clearSensors();
     return COMMAND_SUCCESS;
 }
\ No newline at end of file
@@ -4,8 +4,22 @@
 #include "Commands.h"
 #include "MIRRAModule.h"
 #include "config.h"
+#include <BatterySensor.h>
+#include <ESPCamUART.h>
+#include <LightSensor.h>
+#include <RandomSensor.h>
+#include <ReportedValues.h>
+#include <SensorAggregate.h>
+#include <SensorSet.h>
+#include <SoilTempSensor.h>
+#include <TempHumiSensor.h>
+#include <WakeStub.h>
 #include <vector>
 
+/// @brief The sensors of this node, as configured by SENSOR_TYPES.
+using NodeSensors = SensorSet<SENSOR_TYPES>;
+static_assert(NodeSensors::size <= MAX_SENSORS, "More sensors are configured than MAX_SENSORS.");
+
 class SensorNode : public MIRRAModule
 {
 public:
@@ -25,7 +39,7 @@ public:
         /// @brief Samples the sensors and prints each sample. Unlike sample, this does not forward any data to the local data file and will not impact sensor
         /// scheduling or communications.
         CommandCode printSample();
-        /// @brief Prints scheduling information about the sensors, including tag identifier and next sample time.
+        /// @brief Prints scheduling information about the sensors, including tag identifier, sample interval and next sample time.
         CommandCode printSchedule();
 
         static constexpr auto getCommands()
@@ -43,24 +57,55 @@ private:
     /// @brief Configures this node with a time config message.
     /// @param m Time Config message used to saturate the communication attributes.
     void timeConfig(Message<TIME_CONFIG>& m);
+    /// @brief Listens for a sensor config message from the gateway after a time config has been acknowledged, applying and acknowledging it if one is
+    /// received. Also answers a REPEAT for the time config acknowledgement.
+    /// @param gatewayMAC The gateway MAC address.
+    void awaitSensorConfig(const MACAddress& gatewayMAC);
+    /// @brief Replaces the per-sensor sampling schedules with those of a sensor config message and reschedules all sensors.
+    /// @param m Sensor Config message holding the complete set of schedules.
+    void sensorConfig(Message<SENSOR_CONFIG>& m);
 
-    /// @brief Loads a sensor and its associated scheduled sampling time.
-    /// @param sensor Sensor to load.
-    void addSensor(std::unique_ptr<Sensor>&& sensor);
-    /// @brief Grouping method used to load all sensors. Alter sensor configurations here.
+    /// @brief Constructs all sensors and loads their associated scheduled sampling times. Alter sensor configurations here.
     void initSensors();
-    /// @brief Clears all sensors and saves their associated scheduled sampling times.
+    /// @brief Destroys all sensors and saves their associated scheduled sampling times. Sensors that the wake stub can sample are handed to it.
     void clearSensors();
+    /// @brief Disarms the wake stub and stores the samples it took since the last full boot, one record per sample time.
+    void storeStubSamples();
 
+    /// @brief Starts the measurements of the selected sensors at once, then collects each result as soon as its conversion is ready, light sleeping while
+    /// all pending conversions are still running.
+    /// @param selected Which of the loaded sensors to measure, by index.
+    /// @param results Array to hold the measured values of each sensor.
+    /// @param nResults Array to hold the amount of measured values of each sensor, 0 for those not selected.
+    void measure(const std::array<bool, NodeSensors::size>& selected, std::array<std::array<SensorValue, SENSOR_MAX_VALUES>, NodeSensors::size>& results,
+                 std::array<size_t, NodeSensors::size>& nResults);
+    /// @brief Adds a reading of an aggregated sensor to its running statistics. The statistics of the sample interval that ended before the reading, if any,
+    /// are appended to the values first.
+    /// @param index Index of the sensor.
+    /// @param time Scheduled time of the reading.
+    /// @param value The read value.
+    /// @param values Array of the record's values, to append the statistics to.
+    /// @param nValues Amount of values in the array, updated.
+    void aggregate(size_t index, uint32_t time, const SensorValue& value, std::array<SensorValue, Message<SENSOR_DATA>::maxNValues>& values,
+                   uint8_t& nValues);
+    /// @brief Applies the dead-band of a sensor to one of its values.
+    /// @param index Index of the sensor.
+    /// @param time Scheduled time of the reading.
+    /// @param value The read value.
+    /// @return Whether the value is to be stored, always true for sensors without a dead-band.
+    bool isReported(size_t index, uint32_t time, const SensorValue& value);
     /// @brief Samples all sensors irregardless of scheduling.
     /// @return The sensor data message constructed from the sampled sensors.
     Message<SENSOR_DATA> sampleAll();
-    /// @brief Samples all sensors scheduled at the given time.
-    /// @param cTime Time for which all sampled sensors are scheduled.
-    /// @return The sensor data message constructed from the sampled sensors.
-    Message<SENSOR_DATA> sampleScheduled(uint32_t cTime);
+    /// @brief Samples all sensors scheduled up to the given time, so that sensors with nearby sample times share a single wake and record. The readings of
+    /// aggregated sensors only make it into the record as the statistics of their ended sample intervals, values within the dead-band of their sensor are
+    /// left out.
+    /// @param until Latest scheduled time of the sampled sensors.
+    /// @return The sensor data message constructed from the sampled sensors, holding no values if all were aggregated or dead-banded. Its time is the time
+    /// the sensors were read.
+    Message<SENSOR_DATA> sampleScheduled(uint32_t until);
     /// @brief Updates each sensors' scheduled sampling time if it has expired, given the current time.
-    /// @param cTime The current time.
+    /// @param cTime The current time, or the latest sample time covered by the last sample period.
     void updateSensorsSampleTimes(uint32_t cTime);
     /// @brief Initiates a sampling period.
     void samplePeriod();
@@ -74,8 +119,21 @@ private:
     /// @return Whether the sent message was successfully acknowledged or not.
     bool sendSensorMessage(Message<SENSOR_DATA>& message, const MACAddress& dest, bool& firstMessage);
 
-    std::array<std::unique_ptr<Sensor>, MAX_SENSORS> sensors;
-    size_t nSensors{0};
+    /// @brief Whether scheduled sensors were sampled during this wake.
+    bool sampledThisWake{false};
+    /// @brief Whether this wake did anything besides sampling, i.e. a comm period or the command phase.
+    bool otherWorkThisWake{false};
+
+    NodeSensors sensors;
+    /// @brief Sample interval of each loaded sensor, either from its sensor schedule or the node-wide sample interval. The read interval for aggregated
+    /// sensors.
+    std::array<uint32_t, NodeSensors::size> sensorsSampleIntervals{};
+    /// @brief Interval over which the readings of each loaded sensor are aggregated, 0 if they are stored as they are.
+    std::array<uint32_t, NodeSensors::size> sensorsAggregateIntervals{};
+    /// @brief Dead-band of each loaded sensor, 0 if all of its values are stored.
+    std::array<float, NodeSensors::size> sensorsDeadBands{};
+    /// @brief Maximum time between two stored values of each loaded sensor with a dead-band.
+    std::array<uint32_t, NodeSensors::size> sensorsMaxSilences{};
 };
 
 #endif
@@ -0,0 +1,125 @@
+#include "WakeStubSchedule.h"
+#include <unity.h>
+
+using Schedule = WakeStubSchedule<2, 2>;
+
+static constexpr uint32_t baseTime{1000};
+static constexpr uint32_t ticksPerSecond{10};
+static constexpr uint32_t fullBootTime{2000};
+static constexpr uint32_t coalesceWindow{60};
+
+static uint16_t convert(const Schedule::Channel& channel) { return 100 + channel.sensorIndex; }
+static uint64_t toTick(uint32_t time) { return static_cast<uint64_t>(time - baseTime) * ticksPerSecond; }
+
+/// @return A schedule armed at baseTime with a single channel sampled every 100 s from the given time.
+static Schedule armed(uint32_t nextSampleTime)
+{
+    Schedule schedule;
+    TEST_ASSERT_TRUE(schedule.addChannel({1, 0, -1, -1, 100, nextSampleTime}));
+    schedule.arm(baseTime, 0, ticksPerSecond, fullBootTime, false, coalesceWindow);
+    return schedule;
+}
+
+void setUp() {}
+void tearDown() {}
+
+void test_rejects_zero_interval()
+{
+    Schedule schedule;
+    TEST_ASSERT_FALSE(schedule.addChannel({1, 0, -1, -1, 0, 1100}));
+    TEST_ASSERT_EQUAL(0, schedule.getNChannels());
+}
+
+void test_rejects_channel_without_room()
+{
+    Schedule schedule;
+    TEST_ASSERT_TRUE(schedule.addChannel({0, 0, -1, -1, 100, 1100}));
+    TEST_ASSERT_TRUE(schedule.addChannel({1, 0, -1, -1, 100, 1100}));
+    TEST_ASSERT_FALSE(schedule.addChannel({2, 0, -1, -1, 100, 1100}));
+}
+
+void test_unarmed_boots()
+{
+    Schedule schedule;
+    uint64_t wakeTick{0};
+    TEST_ASSERT_EQUAL(Schedule::FULL_BOOT, schedule.wake(0, convert, wakeTick));
+}
+
+void test_samples_due_channel()
+{
+    Schedule schedule{armed(1100)};
+    TEST_ASSERT_EQUAL_UINT32(1100, schedule.nextSampleTime());
+    uint64_t wakeTick{0};
+    TEST_ASSERT_EQUAL(Schedule::SLEEP, schedule.wake(toTick(1100), convert, wakeTick));
+    TEST_ASSERT_EQUAL(1, schedule.getNSamples());
+    TEST_ASSERT_EQUAL_UINT32(1100, schedule.getSamples()[0].time);
+    TEST_ASSERT_EQUAL_UINT8(1, schedule.getSamples()[0].sensorIndex);
+    TEST_ASSERT_EQUAL_UINT16(101, schedule.getSamples()[0].raw);
+    TEST_ASSERT_EQUAL_UINT32(1200, schedule.getChannels()[0].nextSampleTime);
+    TEST_ASSERT_EQUAL_UINT64(toTick(1200), wakeTick);
+    TEST_ASSERT_EQUAL_UINT32(1, schedule.getNWakes());
+}
+
+void test_skips_missed_samples()
+{
+    Schedule schedule{armed(1100)};
+    uint64_t wakeTick{0};
+    TEST_ASSERT_EQUAL(Schedule::SLEEP, schedule.wake(toTick(1350), convert, wakeTick));
+    TEST_ASSERT_EQUAL(1, schedule.getNSamples());
+    TEST_ASSERT_EQUAL_UINT32(1350, schedule.getSamples()[0].time);
+    TEST_ASSERT_EQUAL_UINT32(1400, schedule.getChannels()[0].nextSampleTime);
+}
+
+void test_stamps_early_wake_with_nearest_time()
+{
+    Schedule schedule{armed(1100)};
+    uint64_t wakeTick{0};
+    TEST_ASSERT_EQUAL(Schedule::SLEEP, schedule.wake(toTick(1100) - ticksPerSecond / 5, convert, wakeTick));
+    TEST_ASSERT_EQUAL(1, schedule.getNSamples());
+    TEST_ASSERT_EQUAL_UINT32(1100, schedule.getSamples()[0].time);
+}
+
+void test_leaves_coalesced_sample_to_full_boot()
+{
+    Schedule schedule{armed(fullBootTime - coalesceWindow / 2)};
+    TEST_ASSERT_EQUAL_UINT32(0, schedule.nextSampleTime());
+    uint64_t wakeTick{0};
+    TEST_ASSERT_EQUAL(Schedule::SLEEP, schedule.wake(toTick(fullBootTime - coalesceWindow / 2), convert, wakeTick));
+    TEST_ASSERT_EQUAL(0, schedule.getNSamples());
+    TEST_ASSERT_EQUAL_UINT64(toTick(fullBootTime), wakeTick);
+}
+
+void test_boots_when_full_boot_due()
+{
+    Schedule schedule{armed(1100)};
+    uint64_t wakeTick{0};
+    TEST_ASSERT_EQUAL(Schedule::FULL_BOOT, schedule.wake(toTick(fullBootTime), convert, wakeTick));
+}
+
+void test_boots_when_buffer_full()
+{
+    Schedule schedule{armed(1100)};
+    uint64_t wakeTick{0};
+    TEST_ASSERT_EQUAL(Schedule::SLEEP, schedule.wake(toTick(1100), convert, wakeTick));
+    TEST_ASSERT_EQUAL(Schedule::SLEEP, schedule.wake(toTick(1200), convert, wakeTick));
+    TEST_ASSERT_EQUAL(Schedule::FULL_BOOT, schedule.wake(toTick(1300), convert, wakeTick));
+    TEST_ASSERT_EQUAL(2, schedule.getNSamples());
+    schedule.clearSamples();
+    TEST_ASSERT_EQUAL(0, schedule.getNSamples());
+    TEST_ASSERT_EQUAL_UINT32(0, schedule.getNWakes());
+}
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_rejects_zero_interval);
+    RUN_TEST(test_rejects_channel_without_room);
+    RUN_TEST(test_unarmed_boots);
+    RUN_TEST(test_samples_due_channel);
+    RUN_TEST(test_skips_missed_samples);
+    RUN_TEST(test_stamps_early_wake_with_nearest_time);
+    RUN_TEST(test_leaves_coalesced_sample_to_full_boot);
+    RUN_TEST(test_boots_when_full_boot_due);
+    RUN_TEST(test_boots_when_buffer_full);
+    return UNITY_END();
+}
@@ -0,0 +1,104 @@
+"""Converts a dump of the event trace ring (see lib/Trace/Trace.h) to Chrome trace_event JSON, to be opened in chrome://tracing or ui.perfetto.dev.
+
+The dump is either read from a file holding the raw serial output of the 'trace' command, or requested directly from a module in command phase:
+
+    python trace_to_chrome.py /dev/ttyUSB0 -o trace.json
+    python trace_to_chrome.py capture.bin -o trace.json
+
+Each core is rendered as a separate thread. Reading from a serial port requires pyserial.
+"""
+import argparse
+import json
+import os
+import struct
+import sys
+import time
+
+MAGIC = b"TRC1"
+HEADER = struct.Struct("<4sII")
+RECORD = struct.Struct("<IBBH")
+
+# (name, phase) of each event in the order of the TraceEvent enum, where phase "B"/"E" begins/ends a span and "i" is an instant event
+EVENTS = [
+    ("radio tx", "B"),
+    ("radio tx", "E"),
+    ("radio rx", "B"),
+    ("radio rx", "E"),
+    ("radio rx timeout", "E"),
+    ("light sleep", "B"),
+    ("light sleep", "E"),
+    ("flash", "B"),
+    ("flash", "E"),
+    ("comm period", "B"),
+    ("comm period", "E"),
+]
+
+
+def read_serial(port, baud, timeout):
+    import serial
+
+    with serial.Serial(port, baud, timeout=timeout) as s:
+        s.reset_input_buffer()
+        s.write(b"trace\n")
+        data = b""
+        deadline = time.monotonic() + timeout
+        while time.monotonic() < deadline:
+            data += s.read(s.in_waiting or 1)
+            start = data.find(MAGIC)
+            if start >= 0 and len(data) >= start + HEADER.size:
+                _, count, _ = HEADER.unpack_from(data, start)
+                if len(data) >= start + HEADER.size + count * RECORD.size:
+                    return data[start:]
+        raise TimeoutError("no complete trace dump received, is the module in command phase?")
+
+
+def parse(data):
+    """Returns the records of the dump in data as (time, event, core, arg) tuples, and the amount of overwritten records."""
+    start = data.find(MAGIC)
+    if start < 0:
+        raise ValueError("no trace dump found")
+    _, count, overwritten = HEADER.unpack_from(data, start)
+    offset = start + HEADER.size
+    if len(data) < offset + count * RECORD.size:
+        raise ValueError(f"trace dump truncated, expected {count} records")
+    return [RECORD.unpack_from(data, offset + i * RECORD.size) for i in range(count)], overwritten
+
+
+def to_chrome(records):
+    events = []
+    previous = None
+    wraps = 0
+    for time_us, event, core, arg in records:
+        # times are truncated to 32 bits on the module, records of different cores may be slightly out of order
+        if previous is not None and time_us + (1 << 31) < previous:
+            wraps += 1
+        previous = time_us
+        name, phase = EVENTS[event] if event < len(EVENTS) else (f"event {event}", "i")
+        entry = {"name": name, "ph": phase, "ts": time_us + (wraps << 32), "pid": 0, "tid": core, "args": {"arg": arg}}
+        if phase == "i":
+            entry["s"] = "t"
+        events.append(entry)
+    return {"traceEvents": events, "displayTimeUnit": "ms"}
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("source", help="serial port of the module, or file holding a captured dump")
+    parser.add_argument("-o", "--output", help="output JSON file (default: stdout)")
+    parser.add_argument("--baud", type=int, default=115200, help="baud rate of the serial port")
+    parser.add_argument("--timeout", type=float, default=10, help="time to wait for the dump in seconds")
+    args = parser.parse_args()
+    if os.path.isfile(args.source):
+        with open(args.source, "rb") as f:
+            data = f.read()
+    else:
+        data = read_serial(args.source, args.baud, args.timeout)
+    records, overwritten = parse(data)
+    if overwritten:
+        sys.stderr.write(f"{overwritten} older records were overwritten in the ring\n")
+    with open(args.output, "w") if args.output else sys.stdout as out:
+        json.dump(to_chrome(records), out)
+
+
+if __name__ == "__main__":
+    main()
@@ -81,11 +81,12 @@ CREATE TABLE IF NOT EXISTS `sensor_measurements` (
   `timestamp` varchar(50) NOT NULL DEFAULT '0',
   `sensor_module_id` int(11) NOT NULL,
   `sensor_type_id` int(11) NOT NULL,
+  `instance` tinyint(4) NOT NULL DEFAULT '0',
   `gateway_id` int(11) NOT NULL,
   `value` decimal(32,4) NOT NULL,
   PRIMARY KEY (`id`),
   UNIQUE KEY `id_UNIQUE` (`id`),
-  UNIQUE KEY `unique_index` (`timestamp`,`sensor_module_id`,`sensor_type_id`,`gateway_id`,`value`),
+  UNIQUE KEY `unique_index` (`timestamp`,`sensor_module_id`,`sensor_type_id`,`instance`,`gateway_id`,`value`),
   KEY `sensor_type_fk_idx` (`sensor_type_id`),
   CONSTRAINT `measurement_sensor_type_fk` FOREIGN KEY (`sensor_type_id`) REFERENCES `sensor_types` (`id`) ON DELETE NO ACTION ON UPDATE NO ACTION
 ) ENGINE=InnoDB AUTO_INCREMENT=119 DEFAULT CHARSET=utf8mb4;
@@ -127,7 +127,8 @@ class mysql_manager:
         try:
             if not self.check_datapoint_exists(timestamp, sensor_module_id, sensor_type_id, gateway_id, value):
                 cursor = connection.cursor()
-                cursor.execute("""INSERT IGNORE INTO sensor_measurements VALUES(NULL,%s,%s,%s,%s,%s)""",
+                cursor.execute("""INSERT IGNORE INTO sensor_measurements(`timestamp`,`sensor_module_id`,`sensor_type_id`,`gateway_id`,`value`)
+                               VALUES(%s,%s,%s,%s,%s)""",
                                (timestamp, sensor_module_id, sensor_type_id, gateway_id, value))
                 connection.commit()
                 return True
@@ -563,6 +564,7 @@ class mysql_manager:
 	                             modules.friendly_name as sensor_module_name,
 				     modules.name as sensor_module_id,
                                      classes.class as sensor_reading_class,
+                                     measurements.instance as instance,
                                      measurements.value as value
                               FROM sensor_measurements as measurements
                               JOIN sensor_modules as modules on measurements.sensor_module_id = modules.id
@@ -0,0 +1,97 @@
+/*
+    mirra_codec: Python extension decoding the sensor data payloads uploaded by the gateways.
+
+    The payload layout is not duplicated here: payloads are decoded with the firmware's own SensorDataBatch and Message<SENSOR_DATA>
+    (firmware/lib/LoRaModule), so the server follows changes to the format on rebuild.
+*/
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+
+#include <SensorDataBatch.h>
+
+#include <vector>
+
+/// @brief Wraps the contents of a vector in a memoryview of the given struct format, e.g. "H" for uint16_t.
+template <typename T> static PyObject* toMemoryView(const std::vector<T>& column, const char* format)
+{
+    PyObject* bytes{PyBytes_FromStringAndSize(reinterpret_cast<const char*>(column.data()), column.size() * sizeof(T))};
+    if (bytes == nullptr)
+        return nullptr;
+    PyObject* view{PyMemoryView_FromObject(bytes)};
+    Py_DECREF(bytes);
+    if (view == nullptr)
+        return nullptr;
+    PyObject* cast{PyObject_CallMethod(view, "cast", "s", format)};
+    Py_DECREF(view);
+    return cast;
+}
+
+static PyObject* decode(PyObject*, PyObject* args, PyObject* kwargs)
+{
+    static const char* keywords[]{"payload", nullptr};
+    Py_buffer payload;
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "y*", const_cast<char**>(keywords), &payload))
+        return nullptr;
+
+    // one entry per value, so the columns can be inserted row by row without further unpacking
+    std::vector<uint16_t> sequences, types;
+    std::vector<uint32_t> times;
+    std::vector<uint8_t> instances;
+    std::vector<float> values;
+    size_t records{0};
+    size_t invalid;
+    Py_BEGIN_ALLOW_THREADS;
+    size_t capacity{static_cast<size_t>(payload.len) / sizeof(SensorValue)};
+    sequences.reserve(capacity);
+    types.reserve(capacity);
+    times.reserve(capacity);
+    instances.reserve(capacity);
+    values.reserve(capacity);
+    invalid = SensorDataBatch::decode(static_cast<const uint8_t*>(payload.buf), payload.len,
+                                      [&](Message<SENSOR_DATA>& message)
+                                      {
+                                          records++;
+                                          const SensorValue* messageValues{message.getValues()};
+                                          for (size_t i{0}; i < message.getNValues(); i++)
+                                          {
+                                              sequences.push_back(message.getSequence());
+                                              times.push_back(message.getCTime());
+                                              types.push_back(messageValues[i].tag >> 4);
+                                              instances.push_back(messageValues[i].tag & 0xF);
+                                              values.push_back(messageValues[i].value);
+                                          }
+                                      });
+    Py_END_ALLOW_THREADS;
+    int format{payload.len > 0 ? static_cast<const uint8_t*>(payload.buf)[0] : 0};
+    PyBuffer_Release(&payload);
+    if (invalid == SIZE_MAX)
+    {
+        PyErr_Format(PyExc_ValueError, "unknown payload format %d", format);
+        return nullptr;
+    }
+    return Py_BuildValue("{s:n,s:n,s:N,s:N,s:N,s:N,s:N}", "records", static_cast<Py_ssize_t>(records), "invalid", static_cast<Py_ssize_t>(invalid),
+                         "sequence", toMemoryView(sequences, "H"), "time", toMemoryView(times, "I"), "type", toMemoryView(types, "H"), "instance",
+                         toMemoryView(instances, "B"), "value", toMemoryView(values, "f"));
+}
+
+static PyMethodDef methods[]{{"decode", reinterpret_cast<PyCFunction>(reinterpret_cast<void (*)()>(decode)), METH_VARARGS | METH_KEYWORDS,
+                              "decode(payload)\n--\n\n"
+                              "Decodes a sensor data payload into columns with one entry per value: a dict holding the amount of decoded and invalid\n"
+                              "records, and memoryviews 'sequence', 'time' (UNIX epoch), 'type', 'instance' and 'value'. Invalid records are skipped.\n"
+                              "The payload is decoded according to the format in its first byte. Raises ValueError for an unknown format."},
+                             {nullptr, nullptr, 0, nullptr}};
+
+static PyModuleDef module{PyModuleDef_HEAD_INIT, "mirra_codec", "Decoder of the sensor data payloads uploaded by MIRRA gateways.", -1, methods};
+
+PyMODINIT_FUNC PyInit_mirra_codec()
+{
+    PyObject* m{PyModule_Create(&module)};
+    if (m == nullptr)
+        return nullptr;
+    if (PyModule_AddIntConstant(m, "FORMAT_BATCH", SensorDataBatch::BATCH) != 0)
+    {
+        Py_DECREF(m);
+        return nullptr;
+    }
+    return m;
+}
@@ -42,3 +42,10 @@ mqqt_settings = {
     'user': 'case12',
     'password': 'mechatronica'
 }
+
+ingest_settings = {
+    'flush_rows': 5000,  # number of buffered measurements that triggers a database write
+    'flush_interval': 2,  # maximum time in seconds a measurement is buffered before it is written
+    'max_rows': 500000,  # maximum number of measurements buffered while the database is unreachable
+    'sensor_type_refresh_interval': 60  # minimum time in seconds between reloads of the sensor types on an unknown type
+}
@@ -0,0 +1,146 @@
+# -*- coding: utf-8 -*-
+"""
+    **********
+    ingest.py
+    **********
+
+    This file contains the buffered ingest of decoded sensor measurements. Measurements of all gateways are gathered
+    in memory and written to the database with multi-row INSERT statements, either when enough rows are buffered or
+    when the oldest buffered row has waited long enough. The database IDs of gateways, sensor modules and sensor types
+    are cached, so a batch only causes queries for gateways or modules that have not been seen before.
+
+    A sensor can report several values under the same type, told apart by their instance tag (e.g. the probes of a soil
+    temperature profile, or the mean, minimum, maximum, standard deviation and count of an aggregated sensor). The
+    instance tag is stored along with the value, as only the sensor module knows which of both it means.
+"""
+
+import math
+import time
+
+from utils import debug_print, convert_epoch_to_mysql_timestamp
+
+
+class measurement_ingest:
+    def __init__(self, manager, flush_rows, flush_interval, max_rows, sensor_type_refresh_interval):
+        """
+        Constructor function for the ingest buffer.
+
+        :param manager: The mysql_manager to write the measurements with.
+        :param int flush_rows: Number of buffered measurements that triggers a flush.
+        :param float flush_interval: Maximum time in seconds a measurement stays buffered before it is flushed.
+        :param int max_rows: Maximum number of buffered measurements while the database cannot be written to,
+            the oldest measurements are dropped beyond it.
+        :param float sensor_type_refresh_interval: Minimum time in seconds between reloads of the known sensor types
+            when a measurement of an unknown type is received.
+        """
+        self.manager = manager
+        self.flush_rows = flush_rows
+        self.flush_interval = flush_interval
+        self.max_rows = max_rows
+        self.sensor_type_refresh_interval = sensor_type_refresh_interval
+        self.gateway_ids = {}
+        self.module_ids = {}
+        self.sensor_type_ids = set()
+        self.sensor_types_loaded = None
+        self.rows = []
+        self.oldest = None
+        self.failed = False
+
+    def __get_id(self, cache, uuid, lookup):
+        """
+        Private function that gets a database ID from a cache, looking it up (and adding the entity) on a miss.
+
+        :return: The ID, None when it could not be looked up or added.
+        """
+        entity_id = cache.get(uuid)
+        if entity_id is None:
+            entity_id = lookup(uuid)
+            if not entity_id:
+                return None
+            cache[uuid] = entity_id
+        return entity_id
+
+    def __is_known_sensor_type(self, sensor_type):
+        """
+        Private function that checks whether a sensor type exists in the database, reloading the known sensor types
+        on a miss at most once per refresh interval. Measurements of unknown types would fail their whole INSERT.
+        """
+        if sensor_type in self.sensor_type_ids:
+            return True
+        now = time.monotonic()
+        if self.sensor_types_loaded is None or now - self.sensor_types_loaded >= self.sensor_type_refresh_interval:
+            self.sensor_types_loaded = now
+            self.sensor_type_ids = self.manager.get_sensor_type_ids()
+        return sensor_type in self.sensor_type_ids
+
+    def add(self, gateway_uuid, module_uuid, batch):
+        """
+        Buffers the measurements of a decoded batch, flushing the buffer when it holds enough rows.
+
+        :param str gateway_uuid: The gateway's UUID (MAC address).
+        :param str module_uuid: The sensor module's UUID (MAC address).
+        :param dict batch: The batch as decoded by mirra_codec.decode.
+        :return: The number of buffered measurements.
+        :rtype: int
+        """
+        gateway_id = self.__get_id(self.gateway_ids, gateway_uuid, self.manager.get_or_add_gateway_id)
+        module_id = self.__get_id(self.module_ids, module_uuid, self.manager.get_or_add_sensor_module_id)
+        if gateway_id is None or module_id is None:
+            debug_print("[Ingest] Could not look up gateway {} or module {}, dropping batch.".format(gateway_uuid, module_uuid))
+            return 0
+
+        buffered = 0
+        previous_epoch = None
+        for epoch_timestamp, sensor_type, instance, value in zip(batch['time'], batch['type'], batch['instance'], batch['value']):
+            if not math.isfinite(value):
+                debug_print('Invalid value received, not inserting data of sensortype {} in database !!'.format(sensor_type))
+                continue
+            if not self.__is_known_sensor_type(sensor_type):
+                debug_print('Unknown sensortype {} received, not inserting data in database !!'.format(sensor_type))
+                continue
+            # the values of a record share their timestamp
+            if epoch_timestamp != previous_epoch:
+                previous_epoch = epoch_timestamp
+                timestamp = convert_epoch_to_mysql_timestamp(epoch_timestamp)
+            self.rows.append((timestamp, module_id, sensor_type, instance, gateway_id, value))
+            buffered += 1
+
+        if buffered and self.oldest is None:
+            self.oldest = time.monotonic()
+        # while the database cannot be written to, retries are left to flush_if_due
+        if len(self.rows) >= self.flush_rows and not self.failed:
+            self.flush()
+        return buffered
+
+    def flush_if_due(self):
+        """
+        Flushes the buffer when its oldest measurement has waited for the flush interval. To be called regularly.
+        """
+        if self.oldest is not None and time.monotonic() - self.oldest >= self.flush_interval:
+            self.flush()
+
+    def flush(self):
+        """
+        Writes all buffered measurements to the database. On error, the measurements are kept for the next flush.
+
+        :return: True on success, False on error.
+        :rtype: bool
+        """
+        if not self.rows:
+            return True
+        try:
+            inserted = self.manager.insert_sensor_measurements(self.rows)
+        except Exception as e:
+            debug_print("[MySQL] Exception during flushing {} measurements: {}".format(len(self.rows), e))
+            if len(self.rows) > self.max_rows:
+                debug_print("[Ingest] Buffer full, dropping {} oldest measurements.".format(len(self.rows) - self.max_rows))
+                del self.rows[:len(self.rows) - self.max_rows]
+            # retry after another interval rather than on every received message
+            self.oldest = time.monotonic()
+            self.failed = True
+            return False
+        debug_print("[MySQL] {} measurements flushed, {} new.".format(len(self.rows), inserted))
+        self.rows = []
+        self.oldest = None
+        self.failed = False
+        return True
@@ -10,12 +10,12 @@
 """
 
 import paho.mqtt.client as mqtt
-import struct
 import config
-import math
+import mirra_codec
 
+from ingest import measurement_ingest
 from mysql_manager import mysql_manager
-from utils import debug_print, get_current_timestamp, convert_epoch_to_mysql_timestamp
+from utils import debug_print
 
 mysql_manager = mysql_manager(config.db_settings['host'],
                               config.db_settings['port'],
@@ -23,6 +23,12 @@ mysql_manager = mysql_manager(config.db_settings['host'],
                               config.db_settings['username'],
                               config.db_settings['password'])
 
+ingest = measurement_ingest(mysql_manager,
+                            config.ingest_settings['flush_rows'],
+                            config.ingest_settings['flush_interval'],
+                            config.ingest_settings['max_rows'],
+                            config.ingest_settings['sensor_type_refresh_interval'])
+
 
 # the callback to be executed when connected to the broker.
 def on_connect(client, userdata, flags, rc):
@@ -32,56 +38,44 @@ def on_connect(client, userdata, flags, rc):
 
 def on_message(client, userdata, msg):
     """
-    Executed when an MQTT message is received. 
+    Executed when an MQTT message is received. Each message holds a batch of records from a single sensor module.
 
     Message format:
-    [timestamp 4]:[n readouts 1]:[readout1 5]:...[readoutn 5]
+    [format 1]:[n records 1]:[record1 length 1]:[record1]:...:[recordn length 1]:[recordn]
+
+    The format byte is FORMAT_BATCH (0) for the layout described here. Payloads of an unknown format are dropped.
+
+    Each record has the following format:
+    [sequence 2]:[timestamp 4]:[n readouts 1]:[readout1 6]:...[readoutn 6]
 
     Each readout has the following format:
-    [sensor_id 1]:[data 4 (float)]
+    [tag 2 (sensor type << 4 | instance)]:[data 4 (float)]
+
+    The payload is decoded by the mirra_codec extension, which is built from the firmware's own message definitions (see setup.py).
+    Its values are buffered and written to the database in bulk, see ingest.py.
     """
     debug_print("[MQTT] message received " + str(msg.topic) + " -- " + str(msg.payload))
     hierarchy = str(msg.topic).split('/')
-    payload = msg.payload
 
     gateway_uuid = hierarchy[1]
     module_uuid = hierarchy[2]
 
     debug_print(f"gateway_uuid: {hierarchy[1]} / module_uuid: {hierarchy[2]}")
 
-    epoch_timestamp = struct.unpack('i', payload[0:4])
-    timestamp = convert_epoch_to_mysql_timestamp(epoch_timestamp[0])
-
-    read_start = 5
-    n_values = payload[4]
-    for i in range(n_values):
-        try:
-            id = payload[read_start + i*6:read_start + i*6 + 1]
-            data = payload[read_start + i*6+2:read_start+(i+1)*6]
-            value = struct.unpack('f', data)[0]
-
-            # if not isinstance(value, int) or not isinstance(value, float):
-            if str(value) == "nan" or math.isnan(value):
-                debug_print('Invalid value received, not inserting data of sensortype {} in database !!'.format(id))
-                #                print('Invalid value received, not inserting data of sensortype {} in database !!'.format(id))
-                debug_print('\nInvalid value = {}'.format(value))
-            #               print('\nInvalid value = {}'.format(value))
-            else:
-                debug_print("id: {} - value {}".format(id, value))
-                # debug_print("id: {} - value {}".format(id, value))
-
-                #              print("[MQTT message] " + str(gateway_uuid) + " | " + str(module_uuid) + " | " + str(id) + " | " + str(value) + " |\t " + str(epoch_timestamp) + " | " + str(get_current_timestamp()))
-                debug_print(
-                    "[MQTT message] " + str(gateway_uuid) + " | " + str(module_uuid) + " | " + str(id) + " | " + str(
-                        value) + " |\t " + str(epoch_timestamp) + " | " + str(get_current_timestamp()))
-
-                result = mysql_manager.process_sensor_module_message(module_uuid, gateway_uuid, id, value, timestamp)
-
-                debug_print("[MySQL] insert status: " + ("OK " if result[0] else "WARNING dup id "))
-        #             print("[MySQL] insert status: " + ("OK " if result[0] else "WARNING dup id "))
-        except Exception as e:
-            debug_print("Exception during unpacking measurement: {} ".format(e))
-    #        print("Exception during unpacking measurement: {} ".format(e))
+    try:
+        batch = mirra_codec.decode(msg.payload)
+    except ValueError as e:
+        debug_print("Exception during decoding of the batch: {} ".format(e))
+        return
+    if batch['invalid']:
+        debug_print("{} malformed records in batch, skipped.".format(batch['invalid']))
+
+    try:
+        buffered = ingest.add(gateway_uuid, module_uuid, batch)
+        debug_print("[Ingest] {} of {} values from {} records buffered.".format(buffered, len(batch['value']), batch['records']))
+    except Exception as e:
+        debug_print("Exception during ingesting batch: {} ".format(e))
+
 
 if __name__ == "__main__":
     print("Starting MQTT message handler.")
@@ -98,3 +92,4 @@ if __name__ == "__main__":
     print("[MQTT] Client background thread started")
     while 1:
         client.loop()
+        ingest.flush_if_due()
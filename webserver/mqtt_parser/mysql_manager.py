@@ -127,7 +127,8 @@ class mysql_manager:
         try:
             if not self.check_datapoint_exists(timestamp, sensor_module_id, sensor_type_id, gateway_id, value):
                 cursor = connection.cursor()
-                cursor.execute("""INSERT IGNORE INTO sensor_measurements VALUES(NULL,%s,%s,%s,%s,%s)""",
+                cursor.execute("""INSERT IGNORE INTO sensor_measurements(`timestamp`,`sensor_module_id`,`sensor_type_id`,`gateway_id`,`value`)
+                               VALUES(%s,%s,%s,%s,%s)""",
                                (timestamp, sensor_module_id, sensor_type_id, gateway_id, value))
                 connection.commit()
                 return True
@@ -194,6 +195,73 @@ class mysql_manager:
             else:
                 return False, "Error when persisting the measurement"
 
+    def get_or_add_gateway_id(self, gateway_uuid):
+        """
+        This function gets the database row ID of a gateway, adding the gateway when it is not known yet.
+
+        :param gateway_uuid: The gateway's UUID (MAC address).
+        :return: The row ID of the gateway, False when it could not be added.
+        """
+        gateway_id = self.__get_gateway_id(gateway_uuid)
+        if int(gateway_id) == 0:
+            debug_print('new gateway detected')
+            gateway_id = self.add_gateway(gateway_uuid)
+        return gateway_id
+
+    def get_or_add_sensor_module_id(self, module_uuid):
+        """
+        This function gets the database row ID of a sensor module, adding it as an unclaimed module when it is not known yet.
+
+        :param module_uuid: The sensor module's UUID (MAC address).
+        :return: The row ID of the sensor module, False when it could not be added.
+        """
+        sensor_module_id = self.__get_module_id(module_uuid)
+        if sensor_module_id == 0:
+            debug_print('new unclaimed module detected')
+            sensor_module_id = self.add_new_sensor_module(module_uuid, None, None)
+        return sensor_module_id
+
+    def get_sensor_type_ids(self):
+        """
+        This function gets the IDs of all known sensor types.
+
+        :return: Set of sensor type IDs.
+        :rtype: set
+        """
+        connection = self.__create_connection()
+        try:
+            cursor = connection.cursor()
+            cursor.execute("SELECT id FROM sensor_types")
+            sensor_types = cursor.fetchall()
+        finally:
+            connection.close()
+
+        return {sensor_type['id'] for sensor_type in sensor_types}
+
+    def insert_sensor_measurements(self, measurements):
+        """
+        This function inserts a batch of sensor measurements using multi-row INSERT statements.
+        Measurements that are already present are skipped by the unique key on all columns but the ID,
+        so no separate check for existing datapoints is needed.
+
+        :param measurements: List of (timestamp, sensor_module_id, sensor_type_id, instance, gateway_id, value) tuples.
+            All IDs must exist in the database, an unknown sensor type fails the whole statement.
+        :return: The number of inserted measurements.
+        :rtype: int
+        """
+        connection = self.__create_connection()
+        try:
+            cursor = connection.cursor()
+            # executemany rewrites this into multi-row statements up to the maximum statement length
+            inserted = cursor.executemany(
+                """INSERT INTO sensor_measurements(`timestamp`,`sensor_module_id`,`sensor_type_id`,`instance`,`gateway_id`,`value`)
+                VALUES(%s,%s,%s,%s,%s,%s) ON DUPLICATE KEY UPDATE `id` = `id`""",
+                measurements)
+            connection.commit()
+            return inserted
+        finally:
+            connection.close()
+
     def get_all_forests(self):
         """
         This function simply gets all the forests and returns them.
@@ -563,6 +631,7 @@ class mysql_manager:
 	                             modules.friendly_name as sensor_module_name,
 				     modules.name as sensor_module_id,
                                      classes.class as sensor_reading_class,
+                                     measurements.instance as instance,
                                      measurements.value as value
                               FROM sensor_measurements as measurements
                               JOIN sensor_modules as modules on measurements.sensor_module_id = modules.id
@@ -0,0 +1,29 @@
+# -*- coding: utf-8 -*-
+"""
+    *********
+    setup.py
+    *********
+
+    Builds the mirra_codec extension module, which decodes the sensor data payloads with the firmware's own codec:
+
+        python setup.py build_ext --inplace
+
+    The firmware headers are looked up in ../../firmware/lib, or in the directory given by the MIRRA_FIRMWARE_LIB environment variable.
+"""
+import os
+
+from setuptools import Extension, setup
+
+firmware_lib = os.environ.get("MIRRA_FIRMWARE_LIB", os.path.normpath(
+                              os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", "..", "firmware", "lib")))
+
+setup(
+    name="mirra_codec",
+    ext_modules=[
+        Extension("mirra_codec",
+                  sources=["codec/mirra_codec.cpp"],
+                  include_dirs=[os.path.join(firmware_lib, "LoRaModule"), os.path.join(firmware_lib, "SensorInterface")],
+                  extra_compile_args=["-std=c++17", "-O2"],
+                  language="c++")
+    ]
+)